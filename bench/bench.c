@@ -0,0 +1,493 @@
+#include <shim.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "../scr.h"
+
+
+/**
+ * Benchmark state structure.
+ *   @size: The screen size.
+ *   @scr: The screen.
+ *   @ui: The user interface, used by the pane workload.
+ *   @item: The index items, used by the pane workload.
+ *   @replay: The replay, used by the replay workload.
+ *   @play: The replayed buffer, used by the replay workload.
+ */
+
+struct bench_t {
+	struct scr_size_t size;
+	struct scr_t *scr;
+
+	struct scr_ui_t *ui;
+	char **item;
+
+	struct scr_replay_t *replay;
+	struct scr_buf_t *play;
+};
+
+/**
+ * Workload structure.
+ *   @name: The name.
+ *   @init, done: Optional setup and teardown.
+ *   @frame: Draw a frame.
+ */
+
+struct work_t {
+	const char *name;
+
+	void (*init)(struct bench_t *bench);
+	void (*done)(struct bench_t *bench);
+	void (*frame)(struct bench_t *bench, struct scr_view_t view, unsigned int n);
+};
+
+
+/*
+ * local function declarations
+ */
+
+static bool bench_run(const struct work_t *work, struct scr_size_t size, unsigned int frames);
+static uint64_t bench_now(void);
+static void bench_text(struct scr_view_t view, unsigned int y, unsigned int seed);
+
+static void full_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n);
+static void cell_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n);
+static void scroll_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n);
+static void cursor_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n);
+static void pane_init(struct bench_t *bench);
+static void pane_done(struct bench_t *bench);
+static void pane_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n);
+static struct scr_widget_t pane_widget(void *arg);
+static void uni_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n);
+static void replay_init(struct bench_t *bench);
+static void replay_done(struct bench_t *bench);
+static void replay_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n);
+
+/*
+ * local variables
+ */
+
+#define BENCH_WARM   64
+#define BENCH_FRAMES 1000
+#define BENCH_ITEMS  10000
+#define BENCH_REPLAY 256
+#define BENCH_SWEEP  16
+
+static uint64_t bench_allocs = 0;
+
+static const struct work_t bench_work[] = {
+	{ "full",   NULL,      NULL,      full_frame },
+	{ "cell",   NULL,      NULL,      cell_frame },
+	{ "scroll", NULL,      NULL,      scroll_frame },
+	{ "cursor", NULL,      NULL,      cursor_frame },
+	{ "panes",  pane_init, pane_done, pane_frame },
+	{ "unicode", NULL,     NULL,      uni_frame },
+	{ "replay", replay_init, replay_done, replay_frame },
+};
+
+static const uint32_t uni_code[] = {
+	0x00E9, 0x00F1, 0x00FC, 0x03B1, 0x03BB, 0x03C9, 0x0416, 0x044F,
+	0x2500, 0x2502, 0x250C, 0x2514, 0x2588, 0x25CF, 0x2713, 0x2192,
+	0x4E2D, 0x6587, 0x5B57, 0x7B26, 0x3042, 0x30AB, 0xAC00, 0xD55C,
+};
+
+
+/*
+ * Allocation counting. Every allocation made by the library, the shim, or
+ * the C library itself goes through these wrappers.
+ */
+
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+void *malloc(size_t size)
+{
+	bench_allocs++;
+
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	bench_allocs++;
+
+	return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	bench_allocs++;
+
+	return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+	__libc_free(ptr);
+}
+#endif
+
+
+/**
+ * Main entry point. Each workload is printed as a single JSON line of per
+ * frame averages. The benchmark fails if any steady-state frame allocates
+ * from the heap.
+ *   @argc: The number of arguments.
+ *   @argv: The argument array, optionally the number of frames.
+ *   &returns: The exit status.
+ */
+
+int main(int argc, char **argv)
+{
+	bool pass = true;
+	unsigned int i, frames = BENCH_FRAMES;
+	struct scr_size_t size = { 160, 48 };
+
+	if(argc > 1)
+		frames = strtoul(argv[1], NULL, 0) ?: BENCH_FRAMES;
+
+	for(i = 0; i < sizeof(bench_work) / sizeof(bench_work[0]); i++)
+		pass &= bench_run(&bench_work[i], size, frames);
+
+	return pass ? 0 : 1;
+}
+
+
+/**
+ * Run a single workload against a headless sink. The 'writes' field counts
+ * calls to the port write function, one per flushed frame, not system
+ * calls.
+ *   @work: The workload.
+ *   @size: The screen size.
+ *   @frames: The number of measured frames.
+ *   &returns: True if the measured frames made no heap allocations.
+ */
+
+static bool bench_run(const struct work_t *work, struct scr_size_t size, unsigned int frames)
+{
+	unsigned int i;
+	uint64_t time = 0, allocs = 0;
+	struct scr_stat_t stat = { 0, 0 }, end;
+	struct scr_headless_t *sink;
+	struct scr_buf_t *buf;
+	struct bench_t bench;
+
+	sink = scr_headless_sink(size);
+	bench.size = size;
+	bench.scr = scr_headless_open(sink);
+	bench.ui = NULL;
+	bench.item = NULL;
+	bench.replay = NULL;
+	bench.play = NULL;
+
+	if(work->init != NULL)
+		work->init(&bench);
+
+	for(i = 0; i < BENCH_WARM + frames; i++) {
+		if(i == BENCH_WARM) {
+			stat = scr_stat(bench.scr);
+			allocs = bench_allocs;
+			time = bench_now();
+		}
+
+		buf = scr_buf(bench.scr);
+		work->frame(&bench, scr_view_new(buf), i);
+		scr_swap(bench.scr, buf);
+	}
+
+	time = bench_now() - time;
+	allocs = bench_allocs - allocs;
+	end = scr_stat(bench.scr);
+
+	printf("{\"name\":\"%s\",\"width\":%u,\"height\":%u,\"frames\":%u,\"ns\":%.1f,\"bytes\":%.1f,\"writes\":%.2f,\"allocs\":%.2f}\n",
+		work->name, size.width, size.height, frames,
+		(double)time / frames,
+		(double)(end.bytes - stat.bytes) / frames,
+		(double)(end.writes - stat.writes) / frames,
+		(double)allocs / frames);
+
+	if(work->done != NULL)
+		work->done(&bench);
+
+	scr_close(bench.scr);
+	scr_headless_delete(sink);
+
+	if(allocs > 0)
+		fprintf(stderr, "%s: %.2f heap allocations per steady-state frame\n", work->name, (double)allocs / frames);
+
+	return allocs == 0;
+}
+
+/**
+ * Retrieve the monotonic time.
+ *   &returns: The time in nanoseconds.
+ */
+
+static uint64_t bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Draw a line of text on a row.
+ *   @view: The view.
+ *   @y: The row.
+ *   @seed: The line seed.
+ */
+
+static void bench_text(struct scr_view_t view, unsigned int y, unsigned int seed)
+{
+	unsigned int x;
+
+	for(x = 0; x < view.box.size.width; x++)
+		scr_view_set(view, (struct scr_coord_t){ x, y }, scr_pt_default(((x * 7 + seed) % 31 < 5) ? ' ' : 'a' + (x + seed) % 26));
+}
+
+
+/**
+ * Full repaint, every point changes code and colour.
+ *   @bench: The benchmark.
+ *   @view: The view.
+ *   @n: The frame number.
+ */
+
+static void full_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n)
+{
+	unsigned int x, y;
+	struct scr_pt_t pt;
+
+	for(y = 0; y < view.box.size.height; y++) {
+		for(x = 0; x < view.box.size.width; x++) {
+			pt = scr_pt_default('!' + (x + y + n) % 94);
+			pt.prop.fg = (x + n) % 8;
+			pt.prop.bold = n & 1;
+			scr_view_set(view, (struct scr_coord_t){ x, y }, pt);
+		}
+	}
+}
+
+/**
+ * Single cell change on a static screen.
+ *   @bench: The benchmark.
+ *   @view: The view.
+ *   @n: The frame number.
+ */
+
+static void cell_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n)
+{
+	unsigned int y;
+
+	for(y = 0; y < view.box.size.height; y++)
+		bench_text(view, y, y);
+
+	scr_view_set(view, (struct scr_coord_t){ view.box.size.width / 2, view.box.size.height / 2 }, scr_pt_default('0' + n % 10));
+}
+
+/**
+ * One line scroll, every row shows the content of its lower neighbour.
+ *   @bench: The benchmark.
+ *   @view: The view.
+ *   @n: The frame number.
+ */
+
+static void scroll_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n)
+{
+	unsigned int y;
+
+	for(y = 0; y < view.box.size.height; y++)
+		bench_text(view, y, (y + n) * 11);
+}
+
+/**
+ * Blinking cursor cell on a static screen.
+ *   @bench: The benchmark.
+ *   @view: The view.
+ *   @n: The frame number.
+ */
+
+static void cursor_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n)
+{
+	unsigned int y;
+	struct scr_coord_t coord = { view.box.size.width / 3, view.box.size.height / 3 };
+
+	for(y = 0; y < view.box.size.height; y++)
+		bench_text(view, y, y);
+
+	scr_view_set_neg(view, coord, n & 1);
+}
+
+/**
+ * Setup the split pane workload.
+ *   @bench: The benchmark.
+ */
+
+static void pane_init(struct bench_t *bench)
+{
+	unsigned int i;
+	char str[32];
+
+	bench->item = mem_alloc((BENCH_ITEMS + 1) * sizeof(char *));
+	for(i = 0; i < BENCH_ITEMS; i++) {
+		snprintf(str, sizeof(str), "item %05u", i);
+		bench->item[i] = str_dup(str);
+	}
+
+	bench->item[BENCH_ITEMS] = NULL;
+
+	bench->ui = scr_ui_new(pane_widget, bench);
+	scr_ui_vsplit(bench->ui);
+}
+
+/**
+ * Teardown the split pane workload.
+ *   @bench: The benchmark.
+ */
+
+static void pane_done(struct bench_t *bench)
+{
+	unsigned int i;
+
+	scr_ui_delete(bench->ui);
+
+	for(i = 0; i < BENCH_ITEMS; i++)
+		mem_free(bench->item[i]);
+
+	mem_free(bench->item);
+}
+
+/**
+ * Split panes over a large index, moving the selection every frame. The
+ * index does not scroll, so the selection sweeps down and back up over the
+ * first 'BENCH_SWEEP' rows to stay visible and change the highlighted row
+ * on every frame.
+ *   @bench: The benchmark.
+ *   @view: The view.
+ *   @n: The frame number.
+ */
+
+static void pane_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n)
+{
+	bool term = false;
+
+	scr_ui_keypress(bench->ui, ((n % (2 * BENCH_SWEEP)) < BENCH_SWEEP) ? scr_down_e : scr_up_e, &term);
+	scr_ui_render(bench->ui, view, true);
+}
+
+/**
+ * Create an index widget for a pane.
+ *   @arg: The benchmark.
+ *   &returns: The widget.
+ */
+
+static struct scr_widget_t pane_widget(void *arg)
+{
+	struct bench_t *bench = arg;
+
+	return scr_index_widget(scr_index_arr((const char *const *)bench->item));
+}
+
+/**
+ * Unicode heavy screen, one row changes every frame.
+ *   @bench: The benchmark.
+ *   @view: The view.
+ *   @n: The frame number.
+ */
+
+static void uni_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n)
+{
+	unsigned int x, y, len = sizeof(uni_code) / sizeof(uni_code[0]);
+
+	for(y = 0; y < view.box.size.height; y++) {
+		unsigned int seed = y * 5 + ((y == n % view.box.size.height) ? n : 0);
+
+		for(x = 0; x < view.box.size.width; x++)
+			scr_view_set(view, (struct scr_coord_t){ x, y }, scr_pt_default(uni_code[(x + seed) % len]));
+	}
+}
+
+/**
+ * Record the frames of the replay workload, one changing row per frame on
+ * a static screen, and open them for replay.
+ *   @bench: The benchmark.
+ */
+
+static void replay_init(struct bench_t *bench)
+{
+	int fd;
+	unsigned int i, y;
+	char path[] = "/tmp/scr-bench-XXXXXX";
+	struct scr_snap_t *snap;
+	struct scr_buf_t *buf;
+
+	fd = mkstemp(path);
+	if(fd < 0)
+		_fatal("Failed to create replay file.");
+
+	close(fd);
+
+	snap = scr_snap_open(path);
+	if(snap == NULL)
+		_fatal("Failed to open replay file.");
+
+	buf = scr_buf_new((struct scr_box_t){ { 0, 0 }, bench->size });
+
+	for(i = 0; i < BENCH_REPLAY; i++) {
+		for(y = 0; y < bench->size.height; y++)
+			bench_text(scr_view_new(buf), y, y * 5 + ((y == i % bench->size.height) ? i : 0));
+
+		scr_snap_write(snap, buf);
+	}
+
+	if(!scr_snap_close(snap))
+		_fatal("Failed to write replay file.");
+
+	bench->replay = scr_replay_open(path);
+	unlink(path);
+
+	if(bench->replay == NULL)
+		_fatal("Failed to open replay.");
+
+	bench->play = scr_buf_soa((struct scr_box_t){ { 0, 0 }, bench->size });
+	scr_buf_delete(buf);
+}
+
+/**
+ * Teardown the replay workload.
+ *   @bench: The benchmark.
+ */
+
+static void replay_done(struct bench_t *bench)
+{
+	scr_replay_close(bench->replay);
+	scr_buf_delete(bench->play);
+}
+
+/**
+ * Replay a recording through the screen, applying one recorded frame per
+ * frame and starting over at the end.
+ *   @bench: The benchmark.
+ *   @view: The view.
+ *   @n: The frame number.
+ */
+
+static void replay_frame(struct bench_t *bench, struct scr_view_t view, unsigned int n)
+{
+	struct scr_frame_t frame;
+
+	if(!scr_replay_next(bench->replay, &frame)) {
+		scr_replay_rewind(bench->replay);
+		if(!scr_replay_next(bench->replay, &frame))
+			return;
+	}
+
+	scr_frame_apply(&frame, bench->play);
+	scr_blit(view, bench->play);
+}
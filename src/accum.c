@@ -1,29 +1,42 @@
 #include "common.h"
+#include <string.h>
 #include "accum.h"
+#include "arena.h"
 #include "buf.h"
 
 
 /**
- * Accumulator structure.
- *   @inst: Tree of instances.
- *   @box: Bounding box.
+ * Accumulator row structure.
+ *   @left: The column of the first point.
+ *   @len, cap: The number of points and capacity.
+ *   @pt: The points, blank where unset.
  */
 
-struct scr_accum_t {
-	int top, bottom, left, right;
-
-	struct avltree_t inst;
+struct row_t {
+	int left;
+	unsigned int len, cap;
+	struct scr_pt_t *pt;
 };
 
 /**
- * Coordinate instance.
- *   @pt: The point.
- *   @coord: The coordinates.
+ * Accumulator structure. Rows are held in a growable array starting at
+ * row @base, each row a growable span of points. Spare rows past @nrows
+ * keep their storage for reuse after a reset.
+ *   @top, bottom, left, right: Bounding box.
+ *   @base: The row of the first entry.
+ *   @nrows, cap: The number of rows and capacity.
+ *   @row: The rows.
+ *   @arena: The arena holding the storage, null for the heap.
  */
 
-struct inst_t {
-	struct scr_pt_t pt;
-	struct scr_coord_t coord;
+struct scr_accum_t {
+	int top, bottom, left, right;
+
+	int base;
+	unsigned int nrows, cap;
+	struct row_t *row;
+
+	struct scr_arena_t *arena;
 };
 
 
@@ -31,7 +44,10 @@ struct inst_t {
  * local function declarations
  */
 
-static int scr_coord_cmp(const struct scr_coord_t *c1, const struct scr_coord_t *c2);
+static void accum_init(struct scr_accum_t *accum, struct scr_arena_t *arena);
+static void *accum_grow(struct scr_accum_t *accum, void *ptr, size_t len, size_t size);
+static struct row_t *accum_row(struct scr_accum_t *accum, int y);
+static struct scr_pt_t *accum_span(struct scr_accum_t *accum, struct scr_coord_t coord, size_t n);
 
 
 /**
@@ -43,13 +59,27 @@ _export
 struct scr_accum_t *scr_accum_new()
 {
 	struct scr_accum_t *accum;
-	
+
 	accum = mem_alloc(sizeof(struct scr_accum_t));
-	accum->top = INT_MAX;
-	accum->bottom = INT_MIN;
-	accum->left = INT_MAX;
-	accum->right = INT_MIN;
-	avltree_init(&accum->inst, (compare_f)scr_coord_cmp, mem_free);
+	accum_init(accum, NULL);
+
+	return accum;
+}
+
+/**
+ * Create an accumulator whose storage is allocated from an arena. The
+ * accumulator must still be deleted before the arena is reset.
+ *   @arena: The arena.
+ *   &returns: The accumulator.
+ */
+
+_export
+struct scr_accum_t *scr_accum_arena(struct scr_arena_t *arena)
+{
+	struct scr_accum_t *accum;
+
+	accum = scr_arena_alloc(arena, sizeof(struct scr_accum_t));
+	accum_init(accum, arena);
 
 	return accum;
 }
@@ -62,10 +92,38 @@ struct scr_accum_t *scr_accum_new()
 _export
 void scr_accum_delete(struct scr_accum_t *accum)
 {
-	avltree_destroy(&accum->inst);
+	unsigned int i;
+
+	if(accum->arena != NULL)
+		return;
+
+	for(i = 0; i < accum->cap; i++)
+		mem_delete(accum->row[i].pt);
+
+	mem_delete(accum->row);
 	mem_free(accum);
 }
 
+/**
+ * Reset an accumulator to empty, keeping its storage for reuse.
+ *   @accum: The accumulator.
+ */
+
+_export
+void scr_accum_reset(struct scr_accum_t *accum)
+{
+	unsigned int i;
+
+	for(i = 0; i < accum->nrows; i++)
+		accum->row[i].len = 0;
+
+	accum->top = INT_MAX;
+	accum->bottom = INT_MIN;
+	accum->left = INT_MAX;
+	accum->right = INT_MIN;
+	accum->nrows = 0;
+}
+
 
 /**
  * Set the point at a given coordinate.
@@ -77,30 +135,30 @@ void scr_accum_delete(struct scr_accum_t *accum)
 _export
 void scr_accum_set(struct scr_accum_t *accum, struct scr_coord_t coord, struct scr_pt_t pt)
 {
-	struct inst_t *inst;
-
-	inst = avltree_lookup(&accum->inst, &coord);
-	if(inst == NULL) {
-		inst = mem_alloc(sizeof(struct inst_t));
-		inst->coord = coord;
-		inst->pt = pt;
-
-		if(accum->left > coord.x)
-			accum->left = coord.x;
+	*accum_span(accum, coord, 1) = pt;
+}
 
-		if(accum->right < coord.x)
-			accum->right = coord.x;
+/**
+ * Set a span of points on a row sharing a property set.
+ *   @accum: The accumulator.
+ *   @coord: The coordinates of the first point.
+ *   @code: The codes.
+ *   @n: The number of points.
+ *   @prop: The property set.
+ */
 
-		if(accum->top > coord.y)
-			accum->top = coord.y;
+_export
+void scr_accum_span(struct scr_accum_t *accum, struct scr_coord_t coord, const uint32_t *code, size_t n, struct scr_prop_t prop)
+{
+	size_t i;
+	struct scr_pt_t *pt;
 
-		if(accum->bottom < coord.y)
-			accum->bottom = coord.y;
+	if(n == 0)
+		return;
 
-		avltree_insert(&accum->inst, &inst->coord, inst);
-	}
-	else
-		inst->pt = pt;
+	pt = accum_span(accum, coord, n);
+	for(i = 0; i < n; i++)
+		pt[i] = (struct scr_pt_t){ code[i], prop };
 }
 
 
@@ -142,24 +200,164 @@ struct scr_size_t scr_accum_size(struct scr_accum_t *accum)
 
 
 /**
- * Compare two coordinates.
- *   @c1: The first coordinates.
- *   @c2: The second coordinates.
- *   &returns: Their order.
+ * Initialize an empty accumulator.
+ *   @accum: The accumulator.
+ *   @arena: The arena, null for the heap.
+ */
+
+static void accum_init(struct scr_accum_t *accum, struct scr_arena_t *arena)
+{
+	accum->top = INT_MAX;
+	accum->bottom = INT_MIN;
+	accum->left = INT_MAX;
+	accum->right = INT_MIN;
+	accum->base = 0;
+	accum->nrows = accum->cap = 0;
+	accum->row = NULL;
+	accum->arena = arena;
+}
+
+/**
+ * Grow an allocation. Arena storage is copied into a new allocation, the
+ * old one being released with the arena.
+ *   @accum: The accumulator.
+ *   @ptr: The allocation, may be null.
+ *   @len: The number of bytes to keep.
+ *   @size: The new size in bytes.
+ *   &returns: The new allocation.
  */
 
-static int scr_coord_cmp(const struct scr_coord_t *c1, const struct scr_coord_t *c2)
+static void *accum_grow(struct scr_accum_t *accum, void *ptr, size_t len, size_t size)
 {
-	if(c1->y > c2->y)
-		return -2;
-	else if(c1->y < c2->y)
-		return 2;
-	else if(c1->x > c2->x)
-		return -1;
-	else if(c1->x < c2->x)
-		return 1;
+	void *ret;
+
+	if(accum->arena == NULL)
+		return mem_realloc(ptr, size);
+
+	ret = scr_arena_alloc(accum->arena, size);
+	if(len > 0)
+		memcpy(ret, ptr, len);
+
+	return ret;
+}
+
+/**
+ * Retrieve the row at a given coordinate, adding rows to either end of
+ * the array as needed.
+ *   @accum: The accumulator.
+ *   @y: The row coordinate.
+ *   &returns: The row.
+ */
+
+static struct row_t *accum_row(struct scr_accum_t *accum, int y)
+{
+	unsigned int i, n, cap;
+	struct row_t tmp;
+
+	if(accum->nrows == 0) {
+		accum->base = y;
+		n = 1;
+	}
+	else if(y < accum->base)
+		n = accum->nrows + (accum->base - y);
+	else if(y >= (accum->base + (int)accum->nrows))
+		n = y - accum->base + 1;
 	else
-		return 0;
+		return &accum->row[y - accum->base];
+
+	if(n > accum->cap) {
+		cap = (2 * n > 16) ? (2 * n) : 16;
+		accum->row = accum_grow(accum, accum->row, accum->cap * sizeof(struct row_t), cap * sizeof(struct row_t));
+
+		for(i = accum->cap; i < cap; i++)
+			accum->row[i] = (struct row_t){ 0, 0, 0, NULL };
+
+		accum->cap = cap;
+	}
+
+	if(y < accum->base) {
+		for(i = n - 1; i >= n - accum->nrows; i--) {
+			tmp = accum->row[i];
+			accum->row[i] = accum->row[i - (n - accum->nrows)];
+			accum->row[i - (n - accum->nrows)] = tmp;
+		}
+
+		accum->base = y;
+	}
+
+	accum->nrows = n;
+
+	return &accum->row[y - accum->base];
+}
+
+
+/**
+ * Extend the row at a given coordinate to cover a span, growing the
+ * bounding box.
+ *   @accum: The accumulator.
+ *   @coord: The coordinates of the first point.
+ *   @n: The number of points, non-zero.
+ *   &returns: The first point of the span.
+ */
+
+static struct scr_pt_t *accum_span(struct scr_accum_t *accum, struct scr_coord_t coord, size_t n)
+{
+	struct row_t *row;
+	unsigned int len;
+	int right = coord.x + (int)n - 1;
+
+	row = accum_row(accum, coord.y);
+
+	if(row->len == 0) {
+		if(row->cap < n) {
+			row->cap = (n > 16) ? n : 16;
+			row->pt = accum_grow(accum, row->pt, 0, row->cap * sizeof(struct scr_pt_t));
+		}
+
+		row->left = coord.x;
+		row->len = n;
+	}
+	else {
+		if(coord.x < row->left) {
+			len = row->left - coord.x;
+
+			if((row->len + len) > row->cap) {
+				row->cap = 2 * (row->len + len);
+				row->pt = accum_grow(accum, row->pt, row->len * sizeof(struct scr_pt_t), row->cap * sizeof(struct scr_pt_t));
+			}
+
+			memmove(row->pt + len, row->pt, row->len * sizeof(struct scr_pt_t));
+			scr_span_fill(row->pt, len, scr_pt_blank);
+			row->left = coord.x;
+			row->len += len;
+		}
+
+		if(right >= (row->left + (int)row->len)) {
+			len = right - row->left + 1;
+
+			if(len > row->cap) {
+				row->cap = 2 * len;
+				row->pt = accum_grow(accum, row->pt, row->len * sizeof(struct scr_pt_t), row->cap * sizeof(struct scr_pt_t));
+			}
+
+			scr_span_fill(row->pt + row->len, len - row->len, scr_pt_blank);
+			row->len = len;
+		}
+	}
+
+	if(accum->left > coord.x)
+		accum->left = coord.x;
+
+	if(accum->right < right)
+		accum->right = right;
+
+	if(accum->top > coord.y)
+		accum->top = coord.y;
+
+	if(accum->bottom < coord.y)
+		accum->bottom = coord.y;
+
+	return row->pt + (coord.x - row->left);
 }
 
 
@@ -171,9 +369,9 @@ static int scr_coord_cmp(const struct scr_coord_t *c1, const struct scr_coord_t
 
 struct scr_buf_t *scr_accum_buf(struct scr_accum_t *accum)
 {
-	struct inst_t *inst;
+	unsigned int i;
+	struct row_t *row;
 	struct scr_box_t box;
-	struct avltree_iter_t iter;
 	struct scr_buf_t *buf;
 
 	box.coord.x = accum->left;
@@ -183,9 +381,13 @@ struct scr_buf_t *scr_accum_buf(struct scr_accum_t *accum)
 
 	buf = scr_buf_new(box);
 
-	avltree_iter_init(&iter, &accum->inst);
-	while((inst = avltree_iter_next(&iter)) != NULL)
-		*scr_buf_pt(buf, inst->coord) = inst->pt;
+	for(i = 0; i < accum->nrows; i++) {
+		row = &accum->row[i];
+		if(row->len == 0)
+			continue;
+
+		memcpy(buf->pt + (size_t)(accum->base + i - box.coord.y) * box.size.width + (row->left - box.coord.x), row->pt, row->len * sizeof(struct scr_pt_t));
+	}
 
 	return buf;
 }
@@ -12,15 +12,19 @@
  */
 
 struct scr_accum_t;
+struct scr_arena_t;
 
 /*
  * accumulator function declarations
  */
 
 struct scr_accum_t *scr_accum_new();
+struct scr_accum_t *scr_accum_arena(struct scr_arena_t *arena);
 void scr_accum_delete(struct scr_accum_t *accum);
+void scr_accum_reset(struct scr_accum_t *accum);
 
 void scr_accum_set(struct scr_accum_t *accum, struct scr_coord_t coord, struct scr_pt_t pt);
+void scr_accum_span(struct scr_accum_t *accum, struct scr_coord_t coord, const uint32_t *code, size_t n, struct scr_prop_t prop);
 
 struct scr_buf_t *scr_accum_buf(struct scr_accum_t *accum);
 
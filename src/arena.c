@@ -0,0 +1,215 @@
+#include "common.h"
+#include "arena.h"
+#include "buf.h"
+
+
+/*
+ * arena definitions
+ */
+
+#define ARENA_ALIGN 16
+
+/**
+ * Chunk structure.
+ *   @next: The next chunk.
+ *   @size: The size of the data.
+ *   @data: The data.
+ */
+
+struct chunk_t {
+	struct chunk_t *next;
+	size_t size;
+
+	char data[] __attribute__((aligned(ARENA_ALIGN)));
+};
+
+/**
+ * Arena structure.
+ *   @head, cur: The first and current chunk.
+ *   @off: The offset into the current chunk.
+ *   @nheap: The number of heap allocations made.
+ */
+
+struct scr_arena_t {
+	struct chunk_t *head, *cur;
+	size_t off;
+
+	uint64_t nheap;
+};
+
+
+/*
+ * local function declarations
+ */
+
+static struct chunk_t *chunk_new(struct scr_arena_t *arena, size_t size, struct chunk_t *next);
+
+
+/**
+ * Create a bump arena.
+ *   @size: The initial capacity.
+ *   &returns: The arena.
+ */
+
+_export
+struct scr_arena_t *scr_arena_new(size_t size)
+{
+	struct scr_arena_t *arena;
+
+	arena = mem_alloc(sizeof(struct scr_arena_t));
+	arena->nheap = 0;
+	arena->head = arena->cur = chunk_new(arena, size ?: 4096, NULL);
+	arena->off = 0;
+
+	return arena;
+}
+
+/**
+ * Delete an arena and everything allocated from it.
+ *   @arena: The arena.
+ */
+
+_export
+void scr_arena_delete(struct scr_arena_t *arena)
+{
+	struct chunk_t *chunk;
+
+	while(arena->head != NULL) {
+		chunk = arena->head;
+		arena->head = chunk->next;
+		mem_free(chunk);
+	}
+
+	mem_free(arena);
+}
+
+
+/**
+ * Allocate memory from an arena. The memory is valid until the arena is
+ * reset or deleted.
+ *   @arena: The arena.
+ *   @nbytes: The number of bytes.
+ *   &returns: The memory, aligned to 'ARENA_ALIGN'.
+ */
+
+_export
+void *scr_arena_alloc(struct scr_arena_t *arena, size_t nbytes)
+{
+	void *ptr;
+
+	nbytes = (nbytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+	while((arena->off + nbytes) > arena->cur->size) {
+		if((arena->cur->next == NULL) || (arena->cur->next->size < nbytes))
+			arena->cur->next = chunk_new(arena, 2 * ((nbytes > arena->cur->size) ? nbytes : arena->cur->size), arena->cur->next);
+
+		arena->cur = arena->cur->next;
+		arena->off = 0;
+	}
+
+	ptr = arena->cur->data + arena->off;
+	arena->off += nbytes;
+
+	return ptr;
+}
+
+/**
+ * Print a formatted string into an arena.
+ *   @arena: The arena.
+ *   @format: The format string.
+ *   @...: The printf-style arguments.
+ *   &returns: The string.
+ */
+
+_export
+char *scr_arena_printf(struct scr_arena_t *arena, const char *restrict format, ...)
+{
+	char *str;
+	size_t len;
+	va_list args;
+
+	va_start(args, format);
+	len = str_vlprintf(format, args);
+	va_end(args);
+
+	str = scr_arena_alloc(arena, len + 1);
+
+	va_start(args, format);
+	str_vprintf(str, format, args);
+	va_end(args);
+
+	return str;
+}
+
+/**
+ * Allocate a blank buffer from an arena. The buffer must not be deleted.
+ *   @arena: The arena.
+ *   @box: The box.
+ *   &returns: The buffer.
+ */
+
+_export
+struct scr_buf_t *scr_arena_buf(struct scr_arena_t *arena, struct scr_box_t box)
+{
+	struct scr_buf_t *buf;
+	size_t npts = (size_t)box.size.width * box.size.height;
+
+	buf = scr_arena_alloc(arena, sizeof(struct scr_buf_t) + npts * sizeof(struct scr_pt_t));
+	buf->box = box;
+	buf->gen = 0;
+	buf->stamp = NULL;
+	buf->code = NULL;
+	buf->attr = NULL;
+	scr_span_fill(buf->pt, npts, scr_pt_blank);
+
+	return buf;
+}
+
+
+/**
+ * Reset an arena, releasing all allocations in constant time. The chunks
+ * are kept, so an arena that has reached its working size no longer
+ * touches the heap.
+ *   @arena: The arena.
+ */
+
+_export
+void scr_arena_reset(struct scr_arena_t *arena)
+{
+	arena->cur = arena->head;
+	arena->off = 0;
+}
+
+/**
+ * Retrieve the number of chunks the arena has taken from the heap. Only the
+ * arena itself is counted, not allocations made elsewhere during a frame.
+ *   @arena: The arena.
+ *   &returns: The allocation count.
+ */
+
+_export
+uint64_t scr_arena_heap(struct scr_arena_t *arena)
+{
+	return arena->nheap;
+}
+
+
+/**
+ * Create a chunk.
+ *   @arena: The arena.
+ *   @size: The data size.
+ *   @next: The next chunk.
+ *   &returns: The chunk.
+ */
+
+static struct chunk_t *chunk_new(struct scr_arena_t *arena, size_t size, struct chunk_t *next)
+{
+	struct chunk_t *chunk;
+
+	chunk = mem_alloc(sizeof(struct chunk_t) + size);
+	chunk->next = next;
+	chunk->size = size;
+	arena->nheap++;
+
+	return chunk;
+}
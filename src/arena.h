@@ -0,0 +1,36 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+/*
+ * start header: scr.h
+ */
+
+/* %scr.h% */
+
+/*
+ * structure prototypes
+ */
+
+struct scr_arena_t;
+
+/*
+ * arena function declarations
+ */
+
+struct scr_arena_t *scr_arena_new(size_t size);
+void scr_arena_delete(struct scr_arena_t *arena);
+
+void *scr_arena_alloc(struct scr_arena_t *arena, size_t nbytes);
+char *scr_arena_printf(struct scr_arena_t *arena, const char *restrict format, ...);
+struct scr_buf_t *scr_arena_buf(struct scr_arena_t *arena, struct scr_box_t box);
+
+void scr_arena_reset(struct scr_arena_t *arena);
+uint64_t scr_arena_heap(struct scr_arena_t *arena);
+
+/* %~scr.h% */
+
+/*
+ * end header: scr.h
+ */
+
+#endif
@@ -1,7 +1,109 @@
 #include "common.h"
+#include <string.h>
 #include "buf.h"
 
 
+/**
+ * Clipped blit structure.
+ *   @width, height: The size of the copied region.
+ *   @dx, dy: The offset into the destination buffer.
+ *   @sx, sy: The offset into the source buffer.
+ */
+
+struct blit_t {
+	int width, height;
+	int dx, dy, sx, sy;
+};
+
+
+/*
+ * local function declarations
+ */
+
+static bool blit_clip(struct blit_t *blit, struct scr_buf_t *dest, struct scr_box_t box, struct scr_buf_t *src, bool rel);
+static void blit_copy(const struct blit_t *blit, struct scr_buf_t *dest, struct scr_buf_t *src);
+static void blit_slow(const struct blit_t *blit, struct scr_buf_t *dest, struct scr_buf_t *src, const struct scr_prop_t *prop, bool trans);
+
+
+/**
+ * Retrieve the maximum of two integers.
+ *   @a, b: The integers.
+ *   &returns: The maximum.
+ */
+
+static inline int64_t i64_max(int64_t a, int64_t b)
+{
+	return (a > b) ? a : b;
+}
+
+/**
+ * Retrieve the minimum of two integers.
+ *   @a, b: The integers.
+ *   &returns: The minimum.
+ */
+
+static inline int64_t i64_min(int64_t a, int64_t b)
+{
+	return (a < b) ? a : b;
+}
+
+
+/**
+ * Retrieve a destination row of a blit.
+ *   @blit: The blit.
+ *   @dest: The destination buffer.
+ *   @y: The row of the blit.
+ *   &returns: The first destination point.
+ */
+
+static inline struct scr_pt_t *blit_dest(const struct blit_t *blit, struct scr_buf_t *dest, int y)
+{
+	return scr_buf_row(dest, blit->dy + y) + blit->dx;
+}
+
+/**
+ * Retrieve a source row of a blit.
+ *   @blit: The blit.
+ *   @src: The source buffer.
+ *   @y: The row of the blit.
+ *   &returns: The first source point, or null if the row is blank.
+ */
+
+static inline const struct scr_pt_t *blit_src(const struct blit_t *blit, struct scr_buf_t *src, int y)
+{
+	if(!scr_buf_live(src, blit->sy + y))
+		return NULL;
+
+	return src->pt + (size_t)(blit->sy + y) * src->box.size.width + blit->sx;
+}
+
+/**
+ * Retrieve the destination index of a blit.
+ *   @blit: The blit.
+ *   @dest: The destination buffer.
+ *   @y: The row of the blit.
+ *   &returns: The index of the first destination point.
+ */
+
+static inline size_t blit_didx(const struct blit_t *blit, struct scr_buf_t *dest, int y)
+{
+	return (size_t)(blit->dy + y) * dest->box.size.width + blit->dx;
+}
+
+/**
+ * Retrieve the source index of a blit.
+ *   @blit: The blit.
+ *   @src: The source buffer.
+ *   @y: The row of the blit.
+ *   &returns: The index of the first source point.
+ */
+
+static inline size_t blit_sidx(const struct blit_t *blit, struct scr_buf_t *src, int y)
+{
+	return (size_t)(blit->sy + y) * src->box.size.width + blit->sx;
+}
+
+
 /*
  * global variables
  */
@@ -23,6 +125,10 @@ struct scr_buf_t *scr_buf_new(struct scr_box_t box)
 
 	buf = mem_alloc(sizeof(struct scr_buf_t) + npts * sizeof(struct scr_pt_t));
 	buf->box = box;
+	buf->gen = 0;
+	buf->stamp = NULL;
+	buf->code = NULL;
+	buf->attr = NULL;
 
 	for(i = 0; i < npts; i++)
 		buf->pt[i] = scr_pt_blank;
@@ -30,6 +136,56 @@ struct scr_buf_t *scr_buf_new(struct scr_box_t box)
 	return buf;
 }
 
+/**
+ * Create a new lazy buffer. Every row is stale until first written, so the
+ * points are not initialized.
+ *   @box: The box.
+ *   &returns: The buffer.
+ */
+
+_export
+struct scr_buf_t *scr_buf_lazy(struct scr_box_t box)
+{
+	struct scr_buf_t *buf;
+	size_t npts = (size_t)box.size.width * box.size.height;
+
+	buf = mem_alloc(sizeof(struct scr_buf_t) + npts * sizeof(struct scr_pt_t) + box.size.height * sizeof(uint32_t));
+	buf->box = box;
+	buf->gen = 1;
+	buf->stamp = (uint32_t *)(buf->pt + npts);
+	buf->code = NULL;
+	buf->attr = NULL;
+	memset(buf->stamp, 0x00, box.size.height * sizeof(uint32_t));
+
+	return buf;
+}
+
+/**
+ * Create a new buffer with separate code and attribute planes. Attributes
+ * are packed in place rather than interned, so they compare directly
+ * across buffers.
+ *   @box: The box.
+ *   &returns: The buffer.
+ */
+
+_export
+struct scr_buf_t *scr_buf_soa(struct scr_box_t box)
+{
+	struct scr_buf_t *buf;
+	size_t npts = (size_t)box.size.width * box.size.height;
+
+	buf = mem_alloc(sizeof(struct scr_buf_t) + npts * (sizeof(uint32_t) + sizeof(uint16_t)));
+	buf->box = box;
+	buf->gen = 0;
+	buf->stamp = NULL;
+	buf->code = (uint32_t *)buf->pt;
+	buf->attr = (uint16_t *)(buf->code + npts);
+	scr_plane_code(buf->code, npts, scr_pt_blank.code);
+	scr_plane_attr(buf->attr, npts, scr_prop_pack(scr_pt_blank.prop));
+
+	return buf;
+}
+
 /**
  * Delete a buffer.
  *   @buf: The buffer.
@@ -58,28 +214,42 @@ void scr_buf_replace(struct scr_buf_t **dest, struct scr_buf_t *src)
 
 
 /**
- * Draw one buffer onto another.
+ * Clear a buffer to blank. Lazy buffers only advance their generation,
+ * taking constant time regardless of size.
+ *   @buf: The buffer.
+ */
+
+_export
+void scr_buf_clear(struct scr_buf_t *buf)
+{
+	size_t npts = (size_t)buf->box.size.width * buf->box.size.height;
+
+	if(scr_buf_isplane(buf)) {
+		scr_plane_code(buf->code, npts, scr_pt_blank.code);
+		scr_plane_attr(buf->attr, npts, scr_prop_pack(scr_pt_blank.prop));
+	}
+	else if(buf->stamp == NULL)
+		scr_span_fill(buf->pt, npts, scr_pt_blank);
+	else if(++buf->gen == 0) {
+		memset(buf->stamp, 0x00, buf->box.size.height * sizeof(uint32_t));
+		buf->gen = 1;
+	}
+}
+
+
+/**
+ * Draw one buffer onto another at the same coordinates.
  *   @dest: The destination buffer.
  *   @src: The source buffer.
  */
 
+_export
 void scr_draw_buf(struct scr_buf_t *dest, struct scr_buf_t *src)
 {
-	struct scr_pt_t *pt;
-	unsigned int x, y, left, right, top, bottom;
+	struct blit_t blit;
 
-	left = src->box.coord.x;
-	top = src->box.coord.y;
-	right = left + src->box.size.width;
-	bottom = top + src->box.size.height;
-
-	for(x = left; x < right; x++) {
-		for(y = top; y < bottom; y++) {
-			pt = scr_buf_pt(dest, (struct scr_coord_t){ x, y });
-			if(pt != NULL)
-				*pt = scr_buf_get(src, (struct scr_coord_t){ x, y });
-		}
-	}
+	if(blit_clip(&blit, dest, (struct scr_box_t){ dest->box.coord, dest->box.size }, src, false))
+		blit_copy(&blit, dest, src);
 }
 
 /**
@@ -88,18 +258,326 @@ void scr_draw_buf(struct scr_buf_t *dest, struct scr_buf_t *src)
  *   @src: The source buffer.
  */
 
+_export
 void scr_draw_view(struct scr_view_t dest, struct scr_buf_t *src)
 {
-	struct scr_coord_t coord;
-	unsigned int left, right, top, bottom;
+	scr_blit(dest, src);
+}
+
+
+/**
+ * Blit a buffer onto a view. The source coordinates are relative to the
+ * view, and the copy is clipped once against the view and the destination
+ * buffer before copying whole rows.
+ *   @dest: The destination view.
+ *   @src: The source buffer.
+ */
+
+_export
+void scr_blit(struct scr_view_t dest, struct scr_buf_t *src)
+{
+	struct blit_t blit;
+
+	if(blit_clip(&blit, dest.buf, dest.box, src, true))
+		blit_copy(&blit, dest.buf, src);
+}
+
+/**
+ * Blit a buffer onto a view, skipping blank points of the source.
+ *   @dest: The destination view.
+ *   @src: The source buffer.
+ */
+
+_export
+void scr_blit_trans(struct scr_view_t dest, struct scr_buf_t *src)
+{
+	int x, y;
+	struct blit_t blit;
+	struct scr_pt_t *restrict to;
+	const struct scr_pt_t *restrict from;
+
+	if(!blit_clip(&blit, dest.buf, dest.box, src, true))
+		return;
+
+	if(scr_buf_isplane(dest.buf) || scr_buf_isplane(src)) {
+		blit_slow(&blit, dest.buf, src, NULL, true);
+
+		return;
+	}
+
+	for(y = 0; y < blit.height; y++) {
+		from = blit_src(&blit, src, y);
+		if(from == NULL)
+			continue;
+
+		to = blit_dest(&blit, dest.buf, y);
+		for(x = 0; x < blit.width; x++) {
+			if(!scr_pt_isequal(from[x], scr_pt_blank))
+				to[x] = from[x];
+		}
+	}
+}
+
+/**
+ * Blit the codes of a buffer onto a view, replacing their properties.
+ *   @dest: The destination view.
+ *   @src: The source buffer.
+ *   @prop: The properties.
+ */
+
+_export
+void scr_blit_prop(struct scr_view_t dest, struct scr_buf_t *src, struct scr_prop_t prop)
+{
+	int x, y;
+	struct blit_t blit;
+	struct scr_pt_t *restrict to;
+	const struct scr_pt_t *restrict from;
+
+	if(!blit_clip(&blit, dest.buf, dest.box, src, true))
+		return;
+
+	if(scr_buf_isplane(dest.buf) || scr_buf_isplane(src)) {
+		blit_slow(&blit, dest.buf, src, &prop, false);
+
+		return;
+	}
+
+	for(y = 0; y < blit.height; y++) {
+		to = blit_dest(&blit, dest.buf, y);
+		from = blit_src(&blit, src, y);
+
+		if(from == NULL)
+			scr_span_fill(to, blit.width, (struct scr_pt_t){ scr_pt_blank.code, prop });
+		else {
+			for(x = 0; x < blit.width; x++)
+				to[x] = (struct scr_pt_t){ from[x].code, prop };
+		}
+	}
+}
+
+
+/**
+ * Clip a view against its buffer.
+ *   @view: The view.
+ *   @clip: Out. The visible region, relative to the buffer origin.
+ *   &returns: True if the region is non-empty.
+ */
+
+_export
+bool scr_view_clip(struct scr_view_t view, struct scr_box_t *clip)
+{
+	struct scr_buf_t *buf = view.buf;
+	int64_t left, top, right, bottom;
+
+	left = i64_max(view.box.coord.x, buf->box.coord.x);
+	top = i64_max(view.box.coord.y, buf->box.coord.y);
+	right = i64_min((int64_t)view.box.coord.x + view.box.size.width, (int64_t)buf->box.coord.x + buf->box.size.width);
+	bottom = i64_min((int64_t)view.box.coord.y + view.box.size.height, (int64_t)buf->box.coord.y + buf->box.size.height);
+
+	if((left >= right) || (top >= bottom))
+		return false;
+
+	clip->coord.x = left - buf->box.coord.x;
+	clip->coord.y = top - buf->box.coord.y;
+	clip->size.width = right - left;
+	clip->size.height = bottom - top;
+
+	return true;
+}
+
+
+/**
+ * Fill a span of points. The filled prefix is copied onto the remainder,
+ * doubling each time, so that the copies become wide block stores.
+ *   @pt: The points.
+ *   @n: The number of points.
+ *   @val: The fill value.
+ */
+
+_export
+void scr_span_fill(struct scr_pt_t *restrict pt, size_t n, struct scr_pt_t val)
+{
+	size_t i;
+
+	if(n == 0)
+		return;
+
+	pt[0] = val;
+
+	for(i = 1; i < n; i *= 2)
+		memcpy(pt + i, pt, ((i < (n - i)) ? i : (n - i)) * sizeof(struct scr_pt_t));
+}
+
+/**
+ * Fill the codes of a span of points.
+ *   @pt: The points.
+ *   @n: The number of points.
+ *   @code: The code.
+ */
+
+_export
+void scr_span_code(struct scr_pt_t *restrict pt, size_t n, uint32_t code)
+{
+	size_t i;
 
-	left = src->box.coord.x;
-	top = src->box.coord.y;
+	for(i = 0; i < n; i++)
+		pt[i].code = code;
+}
+
+/**
+ * Fill the properties of a span of points.
+ *   @pt: The points.
+ *   @n: The number of points.
+ *   @prop: The properties.
+ */
+
+_export
+void scr_span_prop(struct scr_pt_t *restrict pt, size_t n, struct scr_prop_t prop)
+{
+	size_t i;
+
+	for(i = 0; i < n; i++)
+		pt[i].prop = prop;
+}
+
+
+/**
+ * Fill a span of a code plane.
+ *   @code: The code plane.
+ *   @n: The number of points.
+ *   @val: The code.
+ */
+
+_export
+void scr_plane_code(uint32_t *restrict code, size_t n, uint32_t val)
+{
+	size_t i;
+
+	for(i = 0; i < n; i++)
+		code[i] = val;
+}
+
+/**
+ * Fill a span of an attribute plane.
+ *   @attr: The attribute plane.
+ *   @n: The number of points.
+ *   @val: The packed attribute.
+ */
+
+_export
+void scr_plane_attr(uint16_t *restrict attr, size_t n, uint16_t val)
+{
+	size_t i;
+
+	for(i = 0; i < n; i++)
+		attr[i] = val;
+}
+
+
+/**
+ * Compute the clipped intersection of a blit. Coordinates of the result are
+ * relative to the source and destination buffer origins.
+ *   @blit: The blit.
+ *   @dest: The destination buffer.
+ *   @box: The destination box in absolute coordinates.
+ *   @src: The source buffer.
+ *   @rel: Flag to treat the source coordinates as relative to the box.
+ *   &returns: True if the intersection is non-empty.
+ */
+
+static bool blit_clip(struct blit_t *blit, struct scr_buf_t *dest, struct scr_box_t box, struct scr_buf_t *src, bool rel)
+{
+	int64_t left, top, right, bottom, offx, offy;
+
+	offx = rel ? box.coord.x : 0;
+	offy = rel ? box.coord.y : 0;
+
+	left = (int64_t)src->box.coord.x + offx;
+	top = (int64_t)src->box.coord.y + offy;
 	right = left + src->box.size.width;
 	bottom = top + src->box.size.height;
 
-	for(coord.x = left; coord.x < right; coord.x++) {
-		for(coord.y = top; coord.y < bottom; coord.y++)
-			scr_view_set(dest, coord, scr_buf_get(src, coord));
+	left = i64_max(left, i64_max((int64_t)box.coord.x, (int64_t)dest->box.coord.x));
+	top = i64_max(top, i64_max((int64_t)box.coord.y, (int64_t)dest->box.coord.y));
+	right = i64_min(right, i64_min((int64_t)box.coord.x + box.size.width, (int64_t)dest->box.coord.x + dest->box.size.width));
+	bottom = i64_min(bottom, i64_min((int64_t)box.coord.y + box.size.height, (int64_t)dest->box.coord.y + dest->box.size.height));
+
+	if((left >= right) || (top >= bottom))
+		return false;
+
+	blit->width = right - left;
+	blit->height = bottom - top;
+	blit->dx = left - dest->box.coord.x;
+	blit->dy = top - dest->box.coord.y;
+	blit->sx = left - offx - src->box.coord.x;
+	blit->sy = top - offy - src->box.coord.y;
+
+	return true;
+}
+
+/**
+ * Copy the rows of a clipped blit.
+ *   @blit: The blit.
+ *   @dest: The destination buffer.
+ *   @src: The source buffer.
+ */
+
+static void blit_copy(const struct blit_t *blit, struct scr_buf_t *dest, struct scr_buf_t *src)
+{
+	int y;
+	size_t di, si;
+	const struct scr_pt_t *from;
+
+	if(scr_buf_isplane(dest) && scr_buf_isplane(src)) {
+		for(y = 0; y < blit->height; y++) {
+			di = blit_didx(blit, dest, y);
+			si = blit_sidx(blit, src, y);
+			memcpy(dest->code + di, src->code + si, blit->width * sizeof(uint32_t));
+			memcpy(dest->attr + di, src->attr + si, blit->width * sizeof(uint16_t));
+		}
+	}
+	else if(scr_buf_isplane(dest) || scr_buf_isplane(src))
+		blit_slow(blit, dest, src, NULL, false);
+	else {
+		for(y = 0; y < blit->height; y++) {
+			from = blit_src(blit, src, y);
+
+			if(from != NULL)
+				memcpy(blit_dest(blit, dest, y), from, blit->width * sizeof(struct scr_pt_t));
+			else
+				scr_span_fill(blit_dest(blit, dest, y), blit->width, scr_pt_blank);
+		}
+	}
+}
+
+/**
+ * Copy a clipped blit point by point, for mixed layouts.
+ *   @blit: The blit.
+ *   @dest: The destination buffer.
+ *   @src: The source buffer.
+ *   @prop: Optional. The replacement properties.
+ *   @trans: Flag to skip blank source points.
+ */
+
+static void blit_slow(const struct blit_t *blit, struct scr_buf_t *dest, struct scr_buf_t *src, const struct scr_prop_t *prop, bool trans)
+{
+	int x, y;
+	struct scr_pt_t pt;
+	struct scr_coord_t dc, sc;
+
+	for(y = 0; y < blit->height; y++) {
+		for(x = 0; x < blit->width; x++) {
+			sc = (struct scr_coord_t){ src->box.coord.x + blit->sx + x, src->box.coord.y + blit->sy + y };
+			dc = (struct scr_coord_t){ dest->box.coord.x + blit->dx + x, dest->box.coord.y + blit->dy + y };
+
+			pt = scr_buf_get(src, sc);
+			if(trans && scr_pt_isequal(pt, scr_pt_blank))
+				continue;
+
+			if(prop != NULL)
+				pt.prop = *prop;
+
+			scr_buf_set(dest, dc, pt);
+		}
 	}
 }
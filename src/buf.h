@@ -8,17 +8,35 @@
 /* %scr.h% */
 
 /**
- * Buffer structure.
+ * Buffer structure. Buffers either hold an array of points, or separate
+ * code and attribute planes.
  *   @box: The buffer box.
+ *   @gen: The generation of lazy buffers.
+ *   @stamp: The row stamps of lazy buffers, null for eager buffers.
+ *   @code, attr: The code and packed attribute planes, null for point arrays.
  *   @pt: The point array.
  */
 
 struct scr_buf_t {
 	struct scr_box_t box;
 
+	uint32_t gen, *stamp;
+
+	uint32_t *code;
+	uint16_t *attr;
+
 	struct scr_pt_t pt[];
 };
 
+/*
+ * packed attribute definitions
+ */
+
+#define SCR_ATTR_BG     4
+#define SCR_ATTR_BOLD   0x100
+#define SCR_ATTR_ULINE  0x200
+#define SCR_ATTR_NEG    0x400
+
 
 /*
  * buffer variables
@@ -31,9 +49,13 @@ extern struct scr_pt_t scr_pt_blank;
  */
 
 struct scr_buf_t *scr_buf_new(struct scr_box_t box);
+struct scr_buf_t *scr_buf_lazy(struct scr_box_t box);
+struct scr_buf_t *scr_buf_soa(struct scr_box_t box);
 void scr_buf_delete(struct scr_buf_t *buf);
 void scr_buf_replace(struct scr_buf_t **dest, struct scr_buf_t *src);
 
+void scr_buf_clear(struct scr_buf_t *buf);
+
 /*
  * draw function declarations
  */
@@ -41,6 +63,50 @@ void scr_buf_replace(struct scr_buf_t **dest, struct scr_buf_t *src);
 void scr_draw_buf(struct scr_buf_t *dest, struct scr_buf_t *src);
 void scr_draw_view(struct scr_view_t dest, struct scr_buf_t *src);
 
+/*
+ * blit function declarations
+ */
+
+void scr_blit(struct scr_view_t dest, struct scr_buf_t *src);
+void scr_blit_trans(struct scr_view_t dest, struct scr_buf_t *src);
+void scr_blit_prop(struct scr_view_t dest, struct scr_buf_t *src, struct scr_prop_t prop);
+
+/*
+ * span function declarations
+ */
+
+bool scr_view_clip(struct scr_view_t view, struct scr_box_t *clip);
+
+void scr_span_fill(struct scr_pt_t *restrict pt, size_t n, struct scr_pt_t val);
+void scr_span_code(struct scr_pt_t *restrict pt, size_t n, uint32_t code);
+void scr_span_prop(struct scr_pt_t *restrict pt, size_t n, struct scr_prop_t prop);
+
+void scr_plane_code(uint32_t *restrict code, size_t n, uint32_t val);
+void scr_plane_attr(uint16_t *restrict attr, size_t n, uint16_t val);
+
+
+/**
+ * Pack a property set into an attribute.
+ *   @prop: The property set.
+ *   &returns: The attribute.
+ */
+
+static inline uint16_t scr_prop_pack(struct scr_prop_t prop)
+{
+	return prop.fg | (prop.bg << SCR_ATTR_BG) | (prop.bold ? SCR_ATTR_BOLD : 0) | (prop.underline ? SCR_ATTR_ULINE : 0) | (prop.neg ? SCR_ATTR_NEG : 0);
+}
+
+/**
+ * Unpack an attribute into a property set.
+ *   @attr: The attribute.
+ *   &returns: The property set.
+ */
+
+static inline struct scr_prop_t scr_prop_unpack(uint16_t attr)
+{
+	return (struct scr_prop_t){ attr & 0xF, (attr >> SCR_ATTR_BG) & 0xF, attr & SCR_ATTR_BOLD, attr & SCR_ATTR_ULINE, attr & SCR_ATTR_NEG };
+}
+
 
 /**
  * Add two coordinate together.
@@ -95,6 +161,50 @@ static inline bool scr_buf_inside(struct scr_buf_t *buf, struct scr_coord_t coor
 	return (coord.x >= 0) && (coord.y >= 0) && (coord.x < buf->box.size.width) && (coord.y < buf->box.size.height);
 }
 
+/**
+ * Determine if the buffer uses separate planes.
+ *   @buf: The buffer.
+ *   &returns: True for planes, false for a point array.
+ */
+
+static inline bool scr_buf_isplane(struct scr_buf_t *buf)
+{
+	return buf->code != NULL;
+}
+
+/**
+ * Determine if a row of the buffer holds content. Rows of a lazy buffer
+ * with a stale stamp read back as blank.
+ *   @buf: The buffer.
+ *   @row: The row, relative to the buffer origin.
+ *   &returns: True if live, false if stale.
+ */
+
+static inline bool scr_buf_live(struct scr_buf_t *buf, unsigned int row)
+{
+	return (buf->stamp == NULL) || (buf->stamp[row] == buf->gen);
+}
+
+/**
+ * Retrieve a row of the buffer for writing, materializing a stale row. Only
+ * valid for point arrays.
+ *   @buf: The buffer.
+ *   @row: The row, relative to the buffer origin.
+ *   &returns: The first point of the row.
+ */
+
+static inline struct scr_pt_t *scr_buf_row(struct scr_buf_t *buf, unsigned int row)
+{
+	struct scr_pt_t *pt = buf->pt + (size_t)row * buf->box.size.width;
+
+	if(!scr_buf_live(buf, row)) {
+		scr_span_fill(pt, buf->box.size.width, scr_pt_blank);
+		buf->stamp[row] = buf->gen;
+	}
+
+	return pt;
+}
+
 /**
  * Retrieve a point.
  *   @buf: The buffer.
@@ -104,19 +214,89 @@ static inline bool scr_buf_inside(struct scr_buf_t *buf, struct scr_coord_t coor
 
 static inline struct scr_pt_t scr_buf_get(struct scr_buf_t *buf, struct scr_coord_t coord)
 {
-	return scr_buf_inside(buf, coord) ? buf->pt[scr_buf_index(buf, coord)] : scr_pt_blank;
+	unsigned int idx;
+
+	if(!scr_buf_inside(buf, coord))
+		return scr_pt_blank;
+
+	idx = scr_buf_index(buf, coord);
+	if(scr_buf_isplane(buf))
+		return (struct scr_pt_t){ buf->code[idx], scr_prop_unpack(buf->attr[idx]) };
+	else if(!scr_buf_live(buf, coord.y - buf->box.coord.y))
+		return scr_pt_blank;
+	else
+		return buf->pt[idx];
 }
 
 /**
- * Retrieve a point inside a buffer.
+ * Retrieve a reference to a point inside a buffer. Deprecated: only point
+ * buffers hold points, so plane buffers always give null. Use 'scr_buf_get'
+ * and 'scr_buf_set', which work with either layout.
  *   @buf: The buffer.
  *   @coord: The coordinate.
- *   &returns: The point, or null if outside the buffer.
+ *   &returns: The point, or null if outside the buffer or a plane buffer.
  */
 
 static inline struct scr_pt_t *scr_buf_pt(struct scr_buf_t *buf, struct scr_coord_t coord)
 {
-	return scr_buf_inside(buf, coord) ? &buf->pt[scr_buf_index(buf, coord)] : NULL;
+	if(!scr_buf_inside(buf, coord) || scr_buf_isplane(buf))
+		return NULL;
+
+	return scr_buf_row(buf, coord.y - buf->box.coord.y) + (coord.x - buf->box.coord.x);
+}
+
+/**
+ * Set a point inside a buffer.
+ *   @buf: The buffer.
+ *   @coord: The coordinate.
+ *   @pt: The point.
+ *   &returns: True if inside the buffer, false otherwise.
+ */
+
+static inline bool scr_buf_set(struct scr_buf_t *buf, struct scr_coord_t coord, struct scr_pt_t pt)
+{
+	unsigned int idx;
+
+	if(!scr_buf_inside(buf, coord))
+		return false;
+
+	if(scr_buf_isplane(buf)) {
+		idx = scr_buf_index(buf, coord);
+		buf->code[idx] = pt.code;
+		buf->attr[idx] = scr_prop_pack(pt.prop);
+	}
+	else
+		*scr_buf_pt(buf, coord) = pt;
+
+	return true;
+}
+
+
+/**
+ * Retrieve the index of a row of a clipped region.
+ *   @buf: The buffer.
+ *   @clip: The clipped region, relative to the buffer origin.
+ *   @y: The row of the region.
+ *   &returns: The index of the first point of the row.
+ */
+
+static inline size_t scr_clip_index(struct scr_buf_t *buf, struct scr_box_t clip, unsigned int y)
+{
+	return (size_t)(clip.coord.y + y) * buf->box.size.width + clip.coord.x;
+}
+
+/**
+ * Retrieve a row of a clipped region for writing. Only valid for point
+ * arrays.
+ *   @buf: The buffer.
+ *   @clip: The clipped region, relative to the buffer origin.
+ *   @y: The row of the region.
+ *   &returns: The first point of the row.
+ */
+
+static inline struct scr_pt_t *scr_clip_row(struct scr_buf_t *buf, struct scr_box_t clip, unsigned int y)
+{
+	return scr_buf_row(buf, clip.coord.y + y) + clip.coord.x;
 }
 
 
@@ -145,10 +325,12 @@ static inline struct scr_view_t scr_view_new(struct scr_buf_t *buf)
 }
 
 /**
- * Retrieve a reference to a point on the view.
+ * Retrieve a reference to a point on the view. Deprecated: views of plane
+ * buffers always give null. Use 'scr_view_get' and 'scr_view_set', which
+ * work with either layout.
  *   @view: The view.
  *   @coord: The coordinates.
- *   &returns: The point or null.
+ *   &returns: The point, or null if outside the view or a plane buffer.
  */
 
 static inline struct scr_pt_t *scr_view_ref(struct scr_view_t view, struct scr_coord_t coord)
@@ -159,6 +341,21 @@ static inline struct scr_pt_t *scr_view_ref(struct scr_view_t view, struct scr_c
 	return scr_buf_pt(view.buf, scr_coord_add(view.box.coord, coord));
 }
 
+/**
+ * Retrieve a point on the view.
+ *   @view: The view.
+ *   @coord: The coordinate.
+ *   &returns: The point, blank if outside the view.
+ */
+
+static inline struct scr_pt_t scr_view_get(struct scr_view_t view, struct scr_coord_t coord)
+{
+	if(!scr_size_inside(view.box.size, coord))
+		return scr_pt_blank;
+
+	return scr_buf_get(view.buf, scr_coord_add(view.box.coord, coord));
+}
+
 /**
  * Set a point on the view.
  *   @view: The view.
@@ -169,16 +366,42 @@ static inline struct scr_pt_t *scr_view_ref(struct scr_view_t view, struct scr_c
 
 static inline bool scr_view_set(struct scr_view_t view, struct scr_coord_t coord, struct scr_pt_t pt)
 {
+	if(!scr_size_inside(view.box.size, coord))
+		return false;
+
+	return scr_buf_set(view.buf, scr_coord_add(view.box.coord, coord), pt);
+}
+
+/**
+ * Modify the packed attribute of a point on the view.
+ *   @view: The view.
+ *   @coord: The coordinate.
+ *   @mask: The attribute bits to modify.
+ *   @set: Flag to set or clear the bits.
+ *   &returns: True if the coordinate is within the view, false otherwise.
+ */
+
+static inline bool scr_view_set_attr(struct scr_view_t view, struct scr_coord_t coord, uint16_t mask, bool set)
+{
+	uint16_t *attr, val;
 	struct scr_pt_t *ref;
 
 	if(!scr_size_inside(view.box.size, coord))
 		return false;
 
-	ref = scr_buf_pt(view.buf, scr_coord_add(view.box.coord, coord));
-	if(ref == NULL)
+	coord = scr_coord_add(view.box.coord, coord);
+	if(!scr_buf_inside(view.buf, coord))
 		return false;
 
-	*ref = pt;
+	if(scr_buf_isplane(view.buf)) {
+		attr = &view.buf->attr[scr_buf_index(view.buf, coord)];
+		*attr = set ? (*attr | mask) : (*attr & ~mask);
+	}
+	else {
+		ref = scr_buf_pt(view.buf, coord);
+		val = scr_prop_pack(ref->prop);
+		ref->prop = scr_prop_unpack(set ? (val | mask) : (val & ~mask));
+	}
 
 	return true;
 }
@@ -198,7 +421,17 @@ static inline bool scr_view_set_code(struct scr_view_t view, struct scr_coord_t
 	if(!scr_size_inside(view.box.size, coord))
 		return false;
 
-	ref = scr_buf_pt(view.buf, scr_coord_add(view.box.coord, coord));
+	coord = scr_coord_add(view.box.coord, coord);
+	if(scr_buf_isplane(view.buf)) {
+		if(!scr_buf_inside(view.buf, coord))
+			return false;
+
+		view.buf->code[scr_buf_index(view.buf, coord)] = code;
+
+		return true;
+	}
+
+	ref = scr_buf_pt(view.buf, coord);
 	if(ref == NULL)
 		return false;
 
@@ -219,6 +452,9 @@ static inline bool scr_view_set_neg(struct scr_view_t view, struct scr_coord_t c
 {
 	struct scr_pt_t *ref;
 
+	if(scr_buf_isplane(view.buf))
+		return scr_view_set_attr(view, coord, SCR_ATTR_NEG, neg);
+
 	ref = scr_view_ref(view, coord);
 	if(ref == NULL)
 		return false;
@@ -240,6 +476,9 @@ static inline bool scr_view_set_uline(struct scr_view_t view, struct scr_coord_t
 {
 	struct scr_pt_t *ref;
 
+	if(scr_buf_isplane(view.buf))
+		return scr_view_set_attr(view, coord, SCR_ATTR_ULINE, uline);
+
 	ref = scr_view_ref(view, coord);
 	if(ref == NULL)
 		return false;
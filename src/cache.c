@@ -0,0 +1,417 @@
+#include "common.h"
+#include "accum.h"
+#include "buf.h"
+#include "cache.h"
+#include "output.h"
+
+
+/**
+ * Cache entry structure.
+ *   @key: The item key.
+ *   @version: The version, including the layout of the output.
+ *   @buf: The rendered points, relative to the starting row.
+ *   @end: The output coordinates after rendering.
+ *   @prop: The output property set after rendering.
+ *   @avail: The number of rows available if rendering was cut short,
+ *     zero if complete.
+ *   @size: The number of bytes held by the entry.
+ *   @next: The next entry in the bucket.
+ *   @newer, older: The adjacent entries in use order.
+ */
+
+struct entry_t {
+	const void *key;
+	uint64_t version;
+
+	struct scr_buf_t *buf;
+	struct scr_coord_t end;
+	struct scr_prop_t prop;
+	unsigned int avail;
+
+	size_t size;
+	struct entry_t *next, *newer, *older;
+};
+
+/**
+ * Rendered chunk cache structure. Entries are hashed by key and evicted
+ * least recently used first once the held bytes pass the limit.
+ *   @limit, used: The byte limit and the number of bytes held.
+ *   @nentries, nbuckets: The number of entries and buckets.
+ *   @bucket: The hash buckets.
+ *   @newest, oldest: The ends of the use order list.
+ *   @accum: The accumulator used for rendering.
+ */
+
+struct scr_cache_t {
+	size_t limit, used;
+
+	unsigned int nentries, nbuckets;
+	struct entry_t **bucket;
+	struct entry_t *newest, *oldest;
+
+	struct scr_accum_t *accum;
+};
+
+
+/*
+ * local function declarations
+ */
+
+static struct entry_t **cache_find(struct scr_cache_t *cache, const void *key);
+static void cache_put(struct scr_cache_t *cache, const void *key, uint64_t version, struct scr_buf_t *buf, struct scr_coord_t end, struct scr_prop_t prop, unsigned int avail);
+static void cache_remove(struct scr_cache_t *cache, struct entry_t *entry);
+static void cache_use(struct scr_cache_t *cache, struct entry_t *entry);
+static void cache_unlink(struct scr_cache_t *cache, struct entry_t *entry);
+static void cache_rehash(struct scr_cache_t *cache);
+
+/*
+ * local variables
+ */
+
+#define CACHE_BUCKETS 64
+
+
+/**
+ * Create a rendered chunk cache.
+ *   @limit: The maximum number of bytes held.
+ *   &returns: The cache.
+ */
+
+_export
+struct scr_cache_t *scr_cache_new(size_t limit)
+{
+	unsigned int i;
+	struct scr_cache_t *cache;
+
+	cache = mem_alloc(sizeof(struct scr_cache_t));
+	cache->limit = limit;
+	cache->used = 0;
+	cache->nentries = 0;
+	cache->nbuckets = CACHE_BUCKETS;
+	cache->bucket = mem_alloc(CACHE_BUCKETS * sizeof(struct entry_t *));
+	cache->newest = cache->oldest = NULL;
+	cache->accum = scr_accum_new();
+
+	for(i = 0; i < CACHE_BUCKETS; i++)
+		cache->bucket[i] = NULL;
+
+	return cache;
+}
+
+/**
+ * Delete a rendered chunk cache.
+ *   @cache: The cache.
+ */
+
+_export
+void scr_cache_delete(struct scr_cache_t *cache)
+{
+	scr_cache_clear(cache);
+	scr_accum_delete(cache->accum);
+	mem_free(cache->bucket);
+	mem_free(cache);
+}
+
+/**
+ * Remove all entries from the cache.
+ *   @cache: The cache.
+ */
+
+_export
+void scr_cache_clear(struct scr_cache_t *cache)
+{
+	while(cache->oldest != NULL)
+		cache_remove(cache, cache->oldest);
+}
+
+
+/**
+ * Render a chunk onto a view through its output, reusing the points of the
+ * last rendering of the same key if the version and the output layout are
+ * unchanged. The output coordinates and property set are advanced as if
+ * the chunk were written directly.
+ *   @cache: The cache.
+ *   @output: The output of the view.
+ *   @view: The view.
+ *   @key: The item key.
+ *   @version: The content version of the item.
+ *   @chunk: The chunk.
+ */
+
+_export
+void scr_cache_chunk(struct scr_cache_t *cache, struct scr_output_t *output, struct scr_view_t view, const void *key, uint64_t version, struct io_chunk_t chunk)
+{
+	struct entry_t *entry;
+	struct scr_buf_t *buf;
+	struct scr_coord_t end;
+	struct scr_prop_t prop;
+	struct scr_output_t accum;
+	unsigned int avail, cut;
+	uint64_t layout[6];
+
+	scr_output_flush(output);
+	if(scr_output_done(output))
+		return;
+
+	layout[0] = output->coord.x;
+	layout[1] = scr_prop_pack(output->prop);
+	layout[2] = output->wrap;
+	layout[3] = output->width;
+	layout[4] = output->offset;
+	layout[5] = output->limit.x;
+	version = scr_cache_hash(version, layout, sizeof(layout));
+	avail = output->limit.y - output->coord.y;
+
+	entry = *cache_find(cache, key);
+	if((entry != NULL) && (entry->version == version) && ((entry->avail == 0) || (entry->avail >= avail))) {
+		cache_use(cache, entry);
+		buf = entry->buf;
+		end = entry->end;
+		prop = entry->prop;
+		cut = 0;
+	}
+	else {
+		scr_accum_reset(cache->accum);
+
+		accum = scr_output_accum(cache->accum);
+		accum.coord = (struct scr_coord_t){ output->coord.x, 0 };
+		accum.prop = output->prop;
+		accum.wrap = output->wrap;
+		accum.width = output->width;
+		accum.offset = output->offset;
+		accum.limit = (struct scr_coord_t){ output->limit.x, avail };
+
+		io_chunk_proc(chunk, scr_output_io(&accum));
+		scr_output_flush(&accum);
+
+		buf = scr_accum_buf(cache->accum);
+		end = accum.coord;
+		prop = accum.prop;
+		cut = scr_output_done(&accum) ? avail : 0;
+		entry = NULL;
+	}
+
+	view.box.coord.y += output->coord.y;
+	view.box.size.height -= output->coord.y;
+	scr_blit(view, buf);
+
+	if(entry == NULL)
+		cache_put(cache, key, version, buf, end, prop, cut);
+
+	output->coord = (struct scr_coord_t){ end.x, output->coord.y + end.y };
+	output->prop = prop;
+}
+
+
+/**
+ * Retrieve the number of bytes held by the cache.
+ *   @cache: The cache.
+ *   &returns: The number of bytes.
+ */
+
+_export
+size_t scr_cache_used(struct scr_cache_t *cache)
+{
+	return cache->used;
+}
+
+/**
+ * Hash a block of memory, suitable for content versions.
+ *   @seed: The seed, typically a previous hash.
+ *   @ptr: The memory.
+ *   @len: The length in bytes.
+ *   &returns: The hash.
+ */
+
+_export
+uint64_t scr_cache_hash(uint64_t seed, const void *ptr, size_t len)
+{
+	size_t i;
+	const uint8_t *byte = ptr;
+	uint64_t hash = 0xcbf29ce484222325 ^ seed;
+
+	for(i = 0; i < len; i++)
+		hash = (hash ^ byte[i]) * 0x100000001b3;
+
+	return hash;
+}
+
+/**
+ * Version function for keys that are the rendered string.
+ *   @key: The string key.
+ *   &returns: The hash of the string.
+ */
+
+_export
+uint64_t scr_cache_str(const void *key)
+{
+	return scr_cache_hash(0, key, str_len(key));
+}
+
+
+/**
+ * Find the bucket slot of a key.
+ *   @cache: The cache.
+ *   @key: The key.
+ *   &returns: The slot pointing at the entry, or at null if not found.
+ */
+
+static struct entry_t **cache_find(struct scr_cache_t *cache, const void *key)
+{
+	struct entry_t **entry;
+	uint64_t hash = (uintptr_t)key * 0x9e3779b97f4a7c15;
+
+	entry = &cache->bucket[(hash >> 32) & (cache->nbuckets - 1)];
+	while((*entry != NULL) && ((*entry)->key != key))
+		entry = &(*entry)->next;
+
+	return entry;
+}
+
+/**
+ * Store a rendering in the cache, replacing any entry of the same key and
+ * evicting the least recently used entries past the limit. The cache takes
+ * ownership of the buffer.
+ *   @cache: The cache.
+ *   @key: The key.
+ *   @version: The version.
+ *   @buf: The rendered points.
+ *   @end: The output coordinates after rendering.
+ *   @prop: The output property set after rendering.
+ *   @avail: The available rows if cut short, zero otherwise.
+ */
+
+static void cache_put(struct scr_cache_t *cache, const void *key, uint64_t version, struct scr_buf_t *buf, struct scr_coord_t end, struct scr_prop_t prop, unsigned int avail)
+{
+	struct entry_t **slot, *entry;
+
+	slot = cache_find(cache, key);
+	entry = *slot;
+
+	if(entry == NULL) {
+		entry = mem_alloc(sizeof(struct entry_t));
+		entry->key = key;
+		entry->next = NULL;
+		entry->newer = entry->older = NULL;
+		*slot = entry;
+
+		cache->nentries++;
+	}
+	else {
+		cache_unlink(cache, entry);
+		cache->used -= entry->size;
+		scr_buf_delete(entry->buf);
+	}
+
+	entry->version = version;
+	entry->buf = buf;
+	entry->end = end;
+	entry->prop = prop;
+	entry->avail = avail;
+	entry->size = sizeof(struct entry_t) + sizeof(struct scr_buf_t) + (size_t)buf->box.size.width * buf->box.size.height * sizeof(struct scr_pt_t);
+
+	cache->used += entry->size;
+	cache_use(cache, entry);
+
+	while((cache->used > cache->limit) && (cache->oldest != NULL))
+		cache_remove(cache, cache->oldest);
+
+	if(cache->nentries > cache->nbuckets)
+		cache_rehash(cache);
+}
+
+/**
+ * Remove an entry from the cache.
+ *   @cache: The cache.
+ *   @entry: The entry.
+ */
+
+static void cache_remove(struct scr_cache_t *cache, struct entry_t *entry)
+{
+	struct entry_t **slot;
+
+	slot = cache_find(cache, entry->key);
+	*slot = entry->next;
+
+	cache_unlink(cache, entry);
+	cache->used -= entry->size;
+	cache->nentries--;
+
+	scr_buf_delete(entry->buf);
+	mem_free(entry);
+}
+
+/**
+ * Mark an entry as the most recently used.
+ *   @cache: The cache.
+ *   @entry: The entry.
+ */
+
+static void cache_use(struct scr_cache_t *cache, struct entry_t *entry)
+{
+	if(cache->newest == entry)
+		return;
+
+	if(entry->newer != NULL)
+		cache_unlink(cache, entry);
+
+	entry->newer = NULL;
+	entry->older = cache->newest;
+
+	if(cache->newest != NULL)
+		cache->newest->newer = entry;
+	else
+		cache->oldest = entry;
+
+	cache->newest = entry;
+}
+
+/**
+ * Unlink an entry from the use order list.
+ *   @cache: The cache.
+ *   @entry: The entry.
+ */
+
+static void cache_unlink(struct scr_cache_t *cache, struct entry_t *entry)
+{
+	if(entry->newer != NULL)
+		entry->newer->older = entry->older;
+	else
+		cache->newest = entry->older;
+
+	if(entry->older != NULL)
+		entry->older->newer = entry->newer;
+	else
+		cache->oldest = entry->newer;
+
+	entry->newer = entry->older = NULL;
+}
+
+/**
+ * Double the number of buckets.
+ *   @cache: The cache.
+ */
+
+static void cache_rehash(struct scr_cache_t *cache)
+{
+	unsigned int i, n = cache->nbuckets;
+	struct entry_t **bucket = cache->bucket, *entry, **slot;
+
+	cache->nbuckets = 2 * n;
+	cache->bucket = mem_alloc(cache->nbuckets * sizeof(struct entry_t *));
+
+	for(i = 0; i < cache->nbuckets; i++)
+		cache->bucket[i] = NULL;
+
+	for(i = 0; i < n; i++) {
+		while((entry = bucket[i]) != NULL) {
+			bucket[i] = entry->next;
+			entry->next = NULL;
+
+			slot = cache_find(cache, entry->key);
+			*slot = entry;
+		}
+	}
+
+	mem_free(bucket);
+}
@@ -0,0 +1,43 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+/*
+ * start header: scr.h
+ */
+
+/* %scr.h% */
+
+/*
+ * structure prototypes
+ */
+
+struct scr_cache_t;
+struct scr_output_t;
+
+/*
+ * cache definitions
+ */
+
+#define SCR_CACHE_SIZE (256 * 1024)
+
+/*
+ * cache function declarations
+ */
+
+struct scr_cache_t *scr_cache_new(size_t limit);
+void scr_cache_delete(struct scr_cache_t *cache);
+void scr_cache_clear(struct scr_cache_t *cache);
+
+void scr_cache_chunk(struct scr_cache_t *cache, struct scr_output_t *output, struct scr_view_t view, const void *key, uint64_t version, struct io_chunk_t chunk);
+
+size_t scr_cache_used(struct scr_cache_t *cache);
+uint64_t scr_cache_hash(uint64_t seed, const void *ptr, size_t len);
+uint64_t scr_cache_str(const void *key);
+
+/* %~scr.h% */
+
+/*
+ * end header: scr.h
+ */
+
+#endif
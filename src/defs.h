@@ -162,13 +162,27 @@ enum scr_key_e {
  * Control signal enumerator.
  *   @scr_propget_e: Retrieve the property.
  *   @scr_propset_e: Set the property.
+ *   @scr_skip_e: Retrieve the number of columns about to be skipped.
+ *   @scr_seek_e: Advance a number of columns, their text having been
+ *     skipped by the producer.
  */
 
 enum scr_ctrl_e {
 	scr_propget_e = 0xb1ca0000,
 	scr_propset_e = 0xb1ca0001,
+	scr_skip_e = 0xb1ca0002,
+	scr_seek_e = 0xb1ca0003,
 };
 
+
+/**
+ * Content version function.
+ *   @key: The item key.
+ *   &returns: The version, changing whenever the rendered content does.
+ */
+
+typedef uint64_t (*scr_version_f)(const void *key);
+
 /* %~scr.h% */
 
 /*
@@ -0,0 +1,438 @@
+#include "common.h"
+#include <string.h>
+#include "buf.h"
+#include "cache.h"
+#include "dlist.h"
+#include "output.h"
+
+
+/**
+ * Operation kind enumerator.
+ *   @op_set_e: Set a single point.
+ *   @op_fill_e: Fill the box.
+ *   @op_border_e: Draw the border of the box.
+ */
+
+enum op_e {
+	op_set_e,
+	op_fill_e,
+	op_border_e
+};
+
+/**
+ * Operation structure.
+ *   @kind: The kind.
+ *   @box: The box of a fill or border, the coordinate of a set.
+ *   @pt: The point.
+ */
+
+struct op_t {
+	enum op_e kind;
+	struct scr_box_t box;
+	struct scr_pt_t pt;
+};
+
+/**
+ * Run structure, a row span of points written by the operations.
+ *   @x, y: The first point.
+ *   @n: The number of points.
+ */
+
+struct run_t {
+	unsigned int x, y, n;
+};
+
+/**
+ * Display list structure. Operations are recorded each frame, hashed as
+ * they arrive, and only rasterized again once the hash changes. On a hash
+ * match the operations are compared with those of the raster, so that a
+ * collision cannot leave a stale raster. Replay copies the written runs of
+ * the raster.
+ *   @size: The recording size.
+ *   @nops, cap: The number of operations and capacity.
+ *   @op: The operations.
+ *   @nprev, pcap: The number of raster operations and capacity.
+ *   @prev: The operations of the raster.
+ *   @hash, cur: The hash of the raster and of the recording.
+ *   @buf: The raster, null before the first rasterization.
+ *   @nruns, nalloc: The number of runs and capacity.
+ *   @run: The runs.
+ */
+
+struct scr_dlist_t {
+	struct scr_size_t size;
+
+	unsigned int nops, cap;
+	struct op_t *op;
+
+	unsigned int nprev, pcap;
+	struct op_t *prev;
+
+	uint64_t hash, cur;
+	struct scr_buf_t *buf;
+
+	unsigned int nruns, nalloc;
+	struct run_t *run;
+};
+
+
+/*
+ * local function declarations
+ */
+
+static void dlist_op(struct scr_dlist_t *dlist, enum op_e kind, struct scr_box_t box, struct scr_pt_t pt);
+static bool dlist_same(struct scr_dlist_t *dlist);
+static void dlist_raster(struct scr_dlist_t *dlist);
+static void dlist_mark(struct scr_dlist_t *dlist, uint8_t *mask, struct scr_coord_t coord, struct scr_pt_t pt);
+
+
+/**
+ * Create an empty display list.
+ *   &returns: The display list.
+ */
+
+_export
+struct scr_dlist_t *scr_dlist_new(void)
+{
+	struct scr_dlist_t *dlist;
+
+	dlist = mem_alloc(sizeof(struct scr_dlist_t));
+	dlist->size = (struct scr_size_t){ 0, 0 };
+	dlist->nops = dlist->cap = 0;
+	dlist->op = NULL;
+	dlist->nprev = dlist->pcap = 0;
+	dlist->prev = NULL;
+	dlist->hash = dlist->cur = 0;
+	dlist->buf = NULL;
+	dlist->nruns = dlist->nalloc = 0;
+	dlist->run = NULL;
+
+	return dlist;
+}
+
+/**
+ * Delete a display list.
+ *   @dlist: The display list.
+ */
+
+_export
+void scr_dlist_delete(struct scr_dlist_t *dlist)
+{
+	if(dlist->buf != NULL)
+		scr_buf_delete(dlist->buf);
+
+	mem_delete(dlist->op);
+	mem_delete(dlist->prev);
+	mem_delete(dlist->run);
+	mem_free(dlist);
+}
+
+
+/**
+ * Begin recording a display list, discarding the previous operations.
+ *   @dlist: The display list.
+ *   @size: The size of the recording.
+ *   &returns: The renderer recording onto the list.
+ */
+
+_export
+struct scr_render_t scr_dlist_begin(struct scr_dlist_t *dlist, struct scr_size_t size)
+{
+	dlist->size = size;
+	dlist->nops = 0;
+	dlist->cur = scr_cache_hash(0, &size, sizeof(size));
+
+	return scr_render_new(scr_dlist_output, dlist, (struct scr_box_t){ { 0, 0 }, size });
+}
+
+/**
+ * Finish recording a display list and replay it onto a view. The list is
+ * only rasterized again if the recording differs from the last one. The
+ * recorded operations are then kept to compare against the next recording.
+ *   @dlist: The display list.
+ *   @view: The view.
+ */
+
+_export
+void scr_dlist_end(struct scr_dlist_t *dlist, struct scr_view_t view)
+{
+	if((dlist->buf == NULL) || (dlist->cur != dlist->hash) || !dlist_same(dlist)) {
+		struct op_t *op = dlist->op;
+		unsigned int cap = dlist->cap;
+
+		dlist_raster(dlist);
+		dlist->hash = dlist->cur;
+
+		dlist->op = dlist->prev;
+		dlist->cap = dlist->pcap;
+		dlist->prev = op;
+		dlist->pcap = cap;
+		dlist->nprev = dlist->nops;
+	}
+
+	scr_dlist_replay(dlist, view);
+}
+
+/**
+ * Replay the last rasterized display list onto a view without recording.
+ * Points not written by the list are left untouched.
+ *   @dlist: The display list.
+ *   @view: The view.
+ */
+
+_export
+void scr_dlist_replay(struct scr_dlist_t *dlist, struct scr_view_t view)
+{
+	int x, y;
+	unsigned int i, n;
+	size_t idx;
+	struct run_t *run;
+	struct scr_box_t clip;
+	struct scr_pt_t *pt;
+
+	if((dlist->buf == NULL) || !scr_view_clip(view, &clip))
+		return;
+
+	for(i = 0; i < dlist->nruns; i++) {
+		run = &dlist->run[i];
+
+		x = view.box.coord.x - view.buf->box.coord.x + run->x;
+		y = view.box.coord.y - view.buf->box.coord.y + run->y;
+		if((y < clip.coord.y) || (y >= clip.coord.y + (int)clip.size.height))
+			continue;
+
+		n = run->n;
+		pt = dlist->buf->pt + (size_t)run->y * dlist->size.width + run->x;
+
+		if(x < clip.coord.x) {
+			if((unsigned int)(clip.coord.x - x) >= n)
+				continue;
+
+			n -= clip.coord.x - x;
+			pt += clip.coord.x - x;
+			x = clip.coord.x;
+		}
+
+		if(x + (int)n > clip.coord.x + (int)clip.size.width) {
+			if(x >= clip.coord.x + (int)clip.size.width)
+				continue;
+
+			n = clip.coord.x + clip.size.width - x;
+		}
+
+		if(scr_buf_isplane(view.buf)) {
+			idx = (size_t)y * view.buf->box.size.width + x;
+
+			for(; n > 0; n--, idx++, pt++) {
+				view.buf->code[idx] = pt->code;
+				view.buf->attr[idx] = scr_prop_pack(pt->prop);
+			}
+		}
+		else
+			memcpy(scr_buf_row(view.buf, y) + x, pt, n * sizeof(struct scr_pt_t));
+	}
+}
+
+
+/**
+ * Display list output implementation, recording a single point.
+ *   @coord: The coordinate.
+ *   @pt: The point.
+ *   @arg: The display list.
+ */
+
+_export
+void scr_dlist_output(struct scr_coord_t coord, struct scr_pt_t pt, void *arg)
+{
+	dlist_op(arg, op_set_e, (struct scr_box_t){ coord, { 1, 1 } }, pt);
+}
+
+/**
+ * Record a fill of a box of the display list.
+ *   @dlist: The display list.
+ *   @box: The box.
+ *   @pt: The fill point.
+ */
+
+_export
+void scr_dlist_fill(struct scr_dlist_t *dlist, struct scr_box_t box, struct scr_pt_t pt)
+{
+	dlist_op(dlist, op_fill_e, box, pt);
+}
+
+/**
+ * Record a border of a box of the display list.
+ *   @dlist: The display list.
+ *   @box: The box.
+ *   @pt: The border point.
+ */
+
+_export
+void scr_dlist_border(struct scr_dlist_t *dlist, struct scr_box_t box, struct scr_pt_t pt)
+{
+	dlist_op(dlist, op_border_e, box, pt);
+}
+
+
+/**
+ * Append an operation, folding it into the recording hash.
+ *   @dlist: The display list.
+ *   @kind: The kind.
+ *   @box: The box.
+ *   @pt: The point.
+ */
+
+static void dlist_op(struct scr_dlist_t *dlist, enum op_e kind, struct scr_box_t box, struct scr_pt_t pt)
+{
+	uint64_t data[5];
+
+	if(dlist->nops == dlist->cap) {
+		dlist->cap = dlist->cap ? (2 * dlist->cap) : 16;
+		dlist->op = mem_realloc(dlist->op, dlist->cap * sizeof(struct op_t));
+	}
+
+	dlist->op[dlist->nops++] = (struct op_t){ kind, box, pt };
+
+	data[0] = kind;
+	data[1] = ((uint64_t)(uint32_t)box.coord.x << 32) | (uint32_t)box.coord.y;
+	data[2] = ((uint64_t)box.size.width << 32) | box.size.height;
+	data[3] = pt.code;
+	data[4] = scr_prop_pack(pt.prop);
+	dlist->cur = scr_cache_hash(dlist->cur, data, sizeof(data));
+}
+
+/**
+ * Compare the recorded operations and size with those of the raster.
+ *   @dlist: The display list, already rasterized.
+ *   &returns: True if the same, false otherwise.
+ */
+
+static bool dlist_same(struct scr_dlist_t *dlist)
+{
+	unsigned int i;
+	struct op_t *op, *prev;
+
+	if((dlist->nops != dlist->nprev) || (dlist->buf->box.size.width != dlist->size.width) || (dlist->buf->box.size.height != dlist->size.height))
+		return false;
+
+	for(i = 0; i < dlist->nops; i++) {
+		op = &dlist->op[i];
+		prev = &dlist->prev[i];
+
+		if((op->kind != prev->kind) || !scr_pt_isequal(op->pt, prev->pt))
+			return false;
+
+		if((op->box.coord.x != prev->box.coord.x) || (op->box.coord.y != prev->box.coord.y))
+			return false;
+
+		if((op->box.size.width != prev->box.size.width) || (op->box.size.height != prev->box.size.height))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Rasterize the recorded operations and collect the written runs.
+ *   @dlist: The display list.
+ */
+
+static void dlist_raster(struct scr_dlist_t *dlist)
+{
+	struct op_t *op;
+	uint8_t *mask;
+	int x, y, left, top, right, bottom;
+	unsigned int i, w = dlist->size.width, h = dlist->size.height;
+
+	if((dlist->buf == NULL) || (dlist->buf->box.size.width != w) || (dlist->buf->box.size.height != h)) {
+		if(dlist->buf != NULL)
+			scr_buf_delete(dlist->buf);
+
+		dlist->buf = scr_buf_new((struct scr_box_t){ { 0, 0 }, dlist->size });
+	}
+
+	dlist->nruns = 0;
+	if((w == 0) || (h == 0))
+		return;
+
+	mask = mem_alloc(w * h);
+	memset(mask, 0x00, w * h);
+
+	for(i = 0; i < dlist->nops; i++) {
+		op = &dlist->op[i];
+		if((op->box.size.width == 0) || (op->box.size.height == 0))
+			continue;
+
+		left = op->box.coord.x;
+		top = op->box.coord.y;
+		right = left + (int)op->box.size.width - 1;
+		bottom = top + (int)op->box.size.height - 1;
+
+		switch(op->kind) {
+		case op_set_e:
+			dlist_mark(dlist, mask, op->box.coord, op->pt);
+			break;
+
+		case op_fill_e:
+			for(y = top; y <= bottom; y++) {
+				for(x = left; x <= right; x++)
+					dlist_mark(dlist, mask, (struct scr_coord_t){ x, y }, op->pt);
+			}
+			break;
+
+		case op_border_e:
+			for(x = left; x <= right; x++) {
+				dlist_mark(dlist, mask, (struct scr_coord_t){ x, top }, op->pt);
+				dlist_mark(dlist, mask, (struct scr_coord_t){ x, bottom }, op->pt);
+			}
+
+			for(y = top + 1; y < bottom; y++) {
+				dlist_mark(dlist, mask, (struct scr_coord_t){ left, y }, op->pt);
+				dlist_mark(dlist, mask, (struct scr_coord_t){ right, y }, op->pt);
+			}
+			break;
+		}
+	}
+
+	for(y = 0; y < (int)h; y++) {
+		for(x = 0; x < (int)w; ) {
+			if(!mask[y * w + x]) {
+				x++;
+				continue;
+			}
+
+			if(dlist->nruns == dlist->nalloc) {
+				dlist->nalloc = dlist->nalloc ? (2 * dlist->nalloc) : 16;
+				dlist->run = mem_realloc(dlist->run, dlist->nalloc * sizeof(struct run_t));
+			}
+
+			dlist->run[dlist->nruns] = (struct run_t){ x, y, 0 };
+			for(; (x < (int)w) && mask[y * w + x]; x++)
+				dlist->run[dlist->nruns].n++;
+
+			dlist->nruns++;
+		}
+	}
+
+	mem_free(mask);
+}
+
+/**
+ * Write a point of the raster, ignoring points outside.
+ *   @dlist: The display list.
+ *   @mask: The written mask.
+ *   @coord: The coordinate.
+ *   @pt: The point.
+ */
+
+static void dlist_mark(struct scr_dlist_t *dlist, uint8_t *mask, struct scr_coord_t coord, struct scr_pt_t pt)
+{
+	size_t idx;
+
+	if((coord.x < 0) || (coord.y < 0) || !scr_size_inside(dlist->size, coord))
+		return;
+
+	idx = (size_t)coord.y * dlist->size.width + coord.x;
+	dlist->buf->pt[idx] = pt;
+	mask[idx] = 1;
+}
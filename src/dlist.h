@@ -0,0 +1,38 @@
+#ifndef DLIST_H
+#define DLIST_H
+
+/*
+ * start header: scr.h
+ */
+
+/* %scr.h% */
+
+/*
+ * structure prototypes
+ */
+
+struct scr_dlist_t;
+struct scr_render_t;
+
+/*
+ * display list function declarations
+ */
+
+struct scr_dlist_t *scr_dlist_new(void);
+void scr_dlist_delete(struct scr_dlist_t *dlist);
+
+struct scr_render_t scr_dlist_begin(struct scr_dlist_t *dlist, struct scr_size_t size);
+void scr_dlist_end(struct scr_dlist_t *dlist, struct scr_view_t view);
+void scr_dlist_replay(struct scr_dlist_t *dlist, struct scr_view_t view);
+
+void scr_dlist_output(struct scr_coord_t coord, struct scr_pt_t pt, void *arg);
+void scr_dlist_fill(struct scr_dlist_t *dlist, struct scr_box_t box, struct scr_pt_t pt);
+void scr_dlist_border(struct scr_dlist_t *dlist, struct scr_box_t box, struct scr_pt_t pt);
+
+/* %~scr.h% */
+
+/*
+ * end header: scr.h
+ */
+
+#endif
@@ -0,0 +1,233 @@
+#include "common.h"
+#include <string.h>
+#include "fmt.h"
+#include "output.h"
+
+
+/**
+ * Operation kind enumerator.
+ *   @op_text_e: Literal text.
+ *   @op_chunk_e: Chunk slot, '%C'.
+ *   @op_str_e: String slot, '%s'.
+ *   @op_int_e: Signed integer slot, '%d'.
+ *   @op_uint_e: Unsigned integer slot, '%u'.
+ *   @op_char_e: Character slot, '%c'.
+ */
+
+enum op_e {
+	op_text_e,
+	op_chunk_e,
+	op_str_e,
+	op_int_e,
+	op_uint_e,
+	op_char_e
+};
+
+/**
+ * Operation structure.
+ *   @kind: The kind.
+ *   @off, len: The offset and length of literal text.
+ */
+
+struct op_t {
+	enum op_e kind;
+	uint32_t off, len;
+};
+
+/**
+ * Compiled format structure.
+ *   @nops: The number of operations.
+ *   @op: The operations.
+ *   @text: The literal text.
+ */
+
+struct scr_fmt_t {
+	unsigned int nops;
+	struct op_t *op;
+	char *text;
+};
+
+
+/*
+ * local function declarations
+ */
+
+static size_t fmt_uint(char *buf, unsigned long val);
+
+
+/**
+ * Compile a format string into a program of literal text and argument
+ * slots. Supported conversions are '%C', '%s', '%d', '%u', '%c', and '%%'.
+ *   @format: The format string.
+ *   &returns: The compiled format.
+ */
+
+_export
+struct scr_fmt_t *scr_fmt_new(const char *restrict format)
+{
+	struct scr_fmt_t *fmt;
+	size_t len = str_len(format), nops = 1, ntext = 0;
+	const char *ptr;
+	struct op_t *op;
+
+	for(ptr = format; *ptr != '\0'; ptr++) {
+		if(*ptr == '%')
+			nops += 2;
+	}
+
+	fmt = mem_alloc(sizeof(struct scr_fmt_t) + nops * sizeof(struct op_t) + len + 1);
+	fmt->op = (struct op_t *)(fmt + 1);
+	fmt->text = (char *)(fmt->op + nops);
+	fmt->nops = 0;
+
+	for(ptr = format; *ptr != '\0'; ) {
+		enum op_e kind;
+
+		if((ptr[0] != '%') || (ptr[1] == '%')) {
+			op = fmt->nops ? &fmt->op[fmt->nops - 1] : NULL;
+			if((op == NULL) || (op->kind != op_text_e)) {
+				op = &fmt->op[fmt->nops++];
+				*op = (struct op_t){ op_text_e, ntext, 0 };
+			}
+
+			fmt->text[ntext++] = *ptr;
+			op->len++;
+			ptr += (ptr[0] == '%') ? 2 : 1;
+
+			continue;
+		}
+
+		switch(ptr[1]) {
+		case 'C': kind = op_chunk_e; break;
+		case 's': kind = op_str_e; break;
+		case 'd': kind = op_int_e; break;
+		case 'u': kind = op_uint_e; break;
+		case 'c': kind = op_char_e; break;
+		default: _fatal("Unsupported format conversion '%%%c'.", ptr[1] ?: ' ');
+		}
+
+		fmt->op[fmt->nops++] = (struct op_t){ kind, 0, 0 };
+		ptr += 2;
+	}
+
+	fmt->text[ntext] = '\0';
+
+	return fmt;
+}
+
+/**
+ * Delete a compiled format.
+ *   @fmt: The compiled format.
+ */
+
+_export
+void scr_fmt_delete(struct scr_fmt_t *fmt)
+{
+	mem_free(fmt);
+}
+
+
+/**
+ * Execute a compiled format on an output.
+ *   @fmt: The compiled format.
+ *   @output: The output.
+ *   @...: The arguments matching the slots.
+ */
+
+_export
+void scr_fmt_exec(struct scr_fmt_t *fmt, struct scr_output_t *output, ...)
+{
+	va_list args;
+
+	va_start(args, output);
+	scr_fmt_vexec(fmt, output, args);
+	va_end(args);
+}
+
+/**
+ * Execute a compiled format on an output using a variable argument list.
+ * Literal text and arguments are written directly, without parsing.
+ *   @fmt: The compiled format.
+ *   @output: The output.
+ *   @args: The arguments matching the slots.
+ */
+
+_export
+void scr_fmt_vexec(struct scr_fmt_t *fmt, struct scr_output_t *output, va_list args)
+{
+	long val;
+	size_t len;
+	unsigned int i;
+	const char *str;
+	char buf[24];
+	struct op_t *op;
+
+	for(i = 0; i < fmt->nops && !scr_output_done(output); i++) {
+		op = &fmt->op[i];
+
+		switch(op->kind) {
+		case op_text_e:
+			scr_output_write(output, fmt->text + op->off, op->len);
+			break;
+
+		case op_chunk_e:
+			io_chunk_proc(va_arg(args, struct io_chunk_t), scr_output_io(output));
+			break;
+
+		case op_str_e:
+			str = va_arg(args, const char *) ?: "(null)";
+			scr_output_write(output, str, str_len(str));
+			break;
+
+		case op_int_e:
+			val = va_arg(args, int);
+			if(val < 0) {
+				buf[0] = '-';
+				len = 1 + fmt_uint(buf + 1, -val);
+			}
+			else
+				len = fmt_uint(buf, val);
+
+			scr_output_write(output, buf, len);
+			break;
+
+		case op_uint_e:
+			len = fmt_uint(buf, va_arg(args, unsigned int));
+			scr_output_write(output, buf, len);
+			break;
+
+		case op_char_e:
+			buf[0] = va_arg(args, int);
+			scr_output_write(output, buf, 1);
+			break;
+		}
+	}
+
+	scr_output_flush(output);
+}
+
+
+/**
+ * Write an unsigned integer in decimal.
+ *   @buf: The buffer, at least 20 bytes.
+ *   @val: The value.
+ *   &returns: The number of digits.
+ */
+
+static size_t fmt_uint(char *buf, unsigned long val)
+{
+	size_t i, n = 0;
+	char tmp;
+
+	do
+		buf[n++] = '0' + (val % 10);
+	while((val /= 10) > 0);
+
+	for(i = 0; i < n / 2; i++) {
+		tmp = buf[i];
+		buf[i] = buf[n - i - 1];
+		buf[n - i - 1] = tmp;
+	}
+
+	return n;
+}
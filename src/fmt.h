@@ -0,0 +1,33 @@
+#ifndef FMT_H
+#define FMT_H
+
+/*
+ * start header: scr.h
+ */
+
+/* %scr.h% */
+
+/*
+ * structure prototypes
+ */
+
+struct scr_fmt_t;
+struct scr_output_t;
+
+/*
+ * format function declarations
+ */
+
+struct scr_fmt_t *scr_fmt_new(const char *restrict format);
+void scr_fmt_delete(struct scr_fmt_t *fmt);
+
+void scr_fmt_exec(struct scr_fmt_t *fmt, struct scr_output_t *output, ...);
+void scr_fmt_vexec(struct scr_fmt_t *fmt, struct scr_output_t *output, va_list args);
+
+/* %~scr.h% */
+
+/*
+ * end header: scr.h
+ */
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+/*
+ * start header: scr.h
+ */
+
+/* %scr.h% */
+
+/*
+ * structure prototypes
+ */
+
+struct scr_t;
+struct scr_vt_t;
+struct scr_headless_t;
+
+/*
+ * headless function declarations
+ */
+
+struct scr_headless_t *scr_headless_new(struct scr_size_t size);
+struct scr_headless_t *scr_headless_sink(struct scr_size_t size);
+void scr_headless_delete(struct scr_headless_t *headless);
+
+struct scr_t *scr_headless_open(struct scr_headless_t *headless);
+
+void scr_headless_input(struct scr_headless_t *headless, const char *buf, size_t len);
+
+struct scr_vt_t *scr_headless_vt(struct scr_headless_t *headless);
+const char *scr_headless_output(struct scr_headless_t *headless, size_t *len);
+void scr_headless_clear(struct scr_headless_t *headless);
+
+/* %~scr.h% */
+
+/*
+ * end header: scr.h
+ */
+
+#endif
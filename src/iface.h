@@ -13,16 +13,61 @@
 
 struct scr_impl_t;
 
+
+/**
+ * Port read function.
+ *   @ref: The reference.
+ *   @timeout: The timeout in milliseconds, negative to wait indefinitely.
+ *   &returns: The next byte, or negative if none arrived in time.
+ */
+
+typedef int (*scr_port_read_f)(void *ref, int timeout);
+
+/**
+ * Port write function.
+ *   @ref: The reference.
+ *   @buf: The bytes.
+ *   @len: The number of bytes.
+ */
+
+typedef void (*scr_port_write_f)(void *ref, const char *buf, size_t len);
+
+/**
+ * Port size function.
+ *   @ref: The reference.
+ *   &returns: The terminal size.
+ */
+
+typedef struct scr_size_t (*scr_port_size_f)(void *ref);
+
+/**
+ * Port interface, replacing the file descriptors of an implementation.
+ *   @read: Read.
+ *   @write: Write.
+ *   @size: Size.
+ */
+
+struct scr_port_i {
+	scr_port_read_f read;
+	scr_port_write_f write;
+	scr_port_size_f size;
+};
+
 /*
  * implementation function declarations
  */
 
 struct scr_impl_t *scr_impl_open(struct io_input_t input, struct io_output_t output);
+struct scr_impl_t *scr_impl_openfd(int input, int output);
+struct scr_impl_t *scr_impl_openport(void *ref, const struct scr_port_i *iface);
 void scr_impl_close(struct scr_impl_t *impl);
 
 int32_t scr_impl_read(struct scr_impl_t *impl, int timeout);
 struct scr_size_t scr_impl_size(struct scr_impl_t *impl);
-void scr_impl_swap(struct scr_impl_t *impl, struct scr_buf_t *buf);
+struct scr_buf_t *scr_impl_swap(struct scr_impl_t *impl, struct scr_buf_t *buf);
+uint64_t scr_impl_stamp(struct scr_impl_t *impl);
+struct scr_stat_t scr_impl_stat(struct scr_impl_t *impl);
+bool scr_impl_failed(struct scr_impl_t *impl);
 
 /* %~scr.h% */
 
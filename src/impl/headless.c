@@ -0,0 +1,242 @@
+#include "../common.h"
+#include <string.h>
+#include "../buf.h"
+#include "../headless.h"
+#include "../iface.h"
+#include "../lat.h"
+#include "../scr.h"
+#include "../vt.h"
+
+
+/**
+ * Headless terminal structure.
+ *   @size: The terminal size.
+ *   @vt: The terminal emulator, null for a sink.
+ *   @in, inoff, inlen, incap: The input queue, its read offset, length, and
+ *     capacity.
+ *   @out, outlen, outcap: The captured output, its length, and capacity.
+ */
+
+struct scr_headless_t {
+	struct scr_size_t size;
+	struct scr_vt_t *vt;
+
+	char *in;
+	size_t inoff, inlen, incap;
+
+	char *out;
+	size_t outlen, outcap;
+};
+
+
+/*
+ * local function declarations
+ */
+
+static int headless_read(void *ref, int timeout);
+static void headless_write(void *ref, const char *buf, size_t len);
+static struct scr_size_t headless_size(void *ref);
+
+static void headless_append(char **buf, size_t *len, size_t *cap, const char *src, size_t n);
+
+/*
+ * local variables
+ */
+
+static const struct scr_port_i headless_iface = { headless_read, headless_write, headless_size };
+
+
+/**
+ * Create a headless terminal. Output is parsed by an in-process terminal
+ * emulator and captured, input is taken from a queue.
+ *   @size: The terminal size.
+ *   &returns: The headless terminal.
+ */
+
+_export
+struct scr_headless_t *scr_headless_new(struct scr_size_t size)
+{
+	struct scr_headless_t *headless;
+
+	headless = mem_alloc(sizeof(struct scr_headless_t));
+	headless->size = size;
+	headless->vt = scr_vt_new(size);
+	headless->in = NULL;
+	headless->inoff = headless->inlen = headless->incap = 0;
+	headless->out = NULL;
+	headless->outlen = headless->outcap = 0;
+
+	return headless;
+}
+
+/**
+ * Create a headless sink. Output is discarded without emulation or
+ * capture, and input is taken from a queue.
+ *   @size: The terminal size.
+ *   &returns: The headless sink.
+ */
+
+_export
+struct scr_headless_t *scr_headless_sink(struct scr_size_t size)
+{
+	struct scr_headless_t *headless;
+
+	headless = scr_headless_new(size);
+	scr_vt_delete(headless->vt);
+	headless->vt = NULL;
+
+	return headless;
+}
+
+/**
+ * Delete a headless terminal. Screens opened on it must be closed first.
+ *   @headless: The headless terminal.
+ */
+
+_export
+void scr_headless_delete(struct scr_headless_t *headless)
+{
+	if(headless->vt != NULL)
+		scr_vt_delete(headless->vt);
+
+	mem_delete(headless->in);
+	mem_delete(headless->out);
+	mem_free(headless);
+}
+
+
+/**
+ * Open a screen on a headless terminal.
+ *   @headless: The headless terminal.
+ *   &returns: The screen.
+ */
+
+_export
+struct scr_t *scr_headless_open(struct scr_headless_t *headless)
+{
+	return scr_new(scr_impl_openport(headless, &headless_iface));
+}
+
+
+/**
+ * Queue input bytes, as if typed at the terminal.
+ *   @headless: The headless terminal.
+ *   @buf: The bytes.
+ *   @len: The number of bytes.
+ */
+
+_export
+void scr_headless_input(struct scr_headless_t *headless, const char *buf, size_t len)
+{
+	if(headless->inoff == headless->inlen)
+		headless->inoff = headless->inlen = 0;
+
+	headless_append(&headless->in, &headless->inlen, &headless->incap, buf, len);
+}
+
+
+/**
+ * Retrieve the terminal emulator of a headless terminal.
+ *   @headless: The headless terminal.
+ *   &returns: The terminal emulator, or null for a sink.
+ */
+
+_export
+struct scr_vt_t *scr_headless_vt(struct scr_headless_t *headless)
+{
+	return headless->vt;
+}
+
+/**
+ * Retrieve the output captured since the last clear.
+ *   @headless: The headless terminal.
+ *   @len: Out. The number of bytes.
+ *   &returns: The bytes.
+ */
+
+_export
+const char *scr_headless_output(struct scr_headless_t *headless, size_t *len)
+{
+	*len = headless->outlen;
+
+	return headless->out;
+}
+
+/**
+ * Clear the captured output. The terminal emulator state is kept.
+ *   @headless: The headless terminal.
+ */
+
+_export
+void scr_headless_clear(struct scr_headless_t *headless)
+{
+	headless->outlen = 0;
+}
+
+
+/**
+ * Read a byte from the input queue. The queue is never waited on.
+ *   @ref: The headless terminal.
+ *   @timeout: Unused.
+ *   &returns: The byte, or negative if the queue is empty.
+ */
+
+static int headless_read(void *ref, int timeout)
+{
+	struct scr_headless_t *headless = ref;
+
+	if(headless->inoff == headless->inlen)
+		return -1;
+
+	return (uint8_t)headless->in[headless->inoff++];
+}
+
+/**
+ * Write bytes to the terminal emulator and the capture.
+ *   @ref: The headless terminal.
+ *   @buf: The bytes.
+ *   @len: The number of bytes.
+ */
+
+static void headless_write(void *ref, const char *buf, size_t len)
+{
+	struct scr_headless_t *headless = ref;
+
+	if(headless->vt == NULL)
+		return;
+
+	scr_vt_feed(headless->vt, buf, len);
+	headless_append(&headless->out, &headless->outlen, &headless->outcap, buf, len);
+}
+
+/**
+ * Retrieve the size of a headless terminal.
+ *   @ref: The headless terminal.
+ *   &returns: The size.
+ */
+
+static struct scr_size_t headless_size(void *ref)
+{
+	return ((struct scr_headless_t *)ref)->size;
+}
+
+
+/**
+ * Append bytes to a growable array.
+ *   @buf: The array reference.
+ *   @len: The length reference.
+ *   @cap: The capacity reference.
+ *   @src: The source bytes.
+ *   @n: The number of bytes.
+ */
+
+static void headless_append(char **buf, size_t *len, size_t *cap, const char *src, size_t n)
+{
+	if((*len + n) > *cap) {
+		*cap = 2 * (*len + n);
+		*buf = mem_realloc(*buf, *cap);
+	}
+
+	memcpy(*buf + *len, src, n);
+	*len += n;
+}
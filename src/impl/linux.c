@@ -1,30 +1,50 @@
 #include "../common.h"
+#include <errno.h>
 #include <poll.h>
 #include <signal.h>
+#include <string.h>
 #include <termios.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
 #include "../buf.h"
 #include "../iface.h"
+#include "../lat.h"
 #include "../scr.h"
 
 
 /**
  * Implementation structure.
  *   @input, output: Input and output file descriptors.
+ *   @ref, port: The port reference and interface, replacing the descriptors.
+ *   @tty, global, sock: The terminal, global registration, and socket flags.
+ *   @fail: Output failure flag, set once a write errors or stalls.
  *   @seqi: The sequence index.
  *   @seq: Buffered input sequence.
  *   @attr: Previous terminal attributes.
+ *   @out, len, cap: The pending output, its length, and its capacity.
+ *   @recv, stamp: The last receive time and the current event time.
+ *   @stat: The output statistics.
  *   @buf: The buffer.
  */
 
 struct scr_impl_t {
 	int input, output;
+	void *ref;
+	const struct scr_port_i *port;
+	bool tty, global, sock, fail;
 
 	int8_t seqi;
 	int32_t seq[3];
 	struct termios attr;
 
+	char *out;
+	size_t len, cap;
+
+	uint64_t recv, stamp;
+	struct scr_stat_t stat;
+
 	struct scr_buf_t *buf;
 };
 
@@ -33,12 +53,15 @@ struct scr_impl_t {
  * local function declarations
  */
 
+static struct scr_impl_t *impl_new(int input, int output, void *ref, const struct scr_port_i *port);
 static void impl_delete(struct scr_impl_t *impl);
 
 static int32_t impl_seq(struct scr_impl_t *impl, int32_t *ch, int8_t len);
+static bool row_isequal(struct scr_buf_t *a, struct scr_buf_t *b, unsigned int y);
 
 static int16_t fdread(struct scr_impl_t *impl, int timeout);
 static void fdwrite(struct scr_impl_t *impl, const char *restrict format, ...);
+static void fdflush(struct scr_impl_t *impl);
 
 static void impl_init();
 static void impl_destroy();
@@ -50,6 +73,8 @@ static void impl_remove(struct scr_impl_t *impl);
  * local variables
  */
 
+#define IMPL_STALL 2000
+
 static bool impl_kill = false;
 static struct thread_once_t impl_once = THREAD_ONCE_INIT;
 static struct thread_mutex_t impl_mutex = THREAD_MUTEX_INIT;
@@ -66,31 +91,89 @@ static struct avltree_t impl_set;
 _export
 struct scr_impl_t *scr_impl_open(struct io_input_t input, struct io_output_t output)
 {
-	struct termios attr;
 	struct scr_impl_t *impl;
 
+	if((input.ref != io_stdin.ref) || (output.ref != io_stdout.ref))
+		_fatal("Screens on arbitrary streams must be opened by file descriptor.");
+
 	thread_once(&impl_once, impl_init);
 
-	impl = mem_alloc(sizeof(struct scr_impl_t));
-	impl->seqi = -1;
+	impl = scr_impl_openfd(STDIN_FILENO, STDOUT_FILENO);
+	impl->global = true;
+	impl_add(impl);
+
+	return impl;
+}
+
+/**
+ * Open an implementation on an input and output file descriptor. The
+ * implementation is not registered for restoration at exit, the caller is
+ * responsible for closing it.
+ *   @input: The input file descriptor.
+ *   @output: The output file descriptor.
+ *   &returns: The implementation.
+ */
 
-	if(input.ref == io_stdin.ref)
-		impl->input = STDIN_FILENO;
+_export
+struct scr_impl_t *scr_impl_openfd(int input, int output)
+{
+	return impl_new(input, output, NULL, NULL);
+}
+
+/**
+ * Open an implementation on a port instead of file descriptors.
+ *   @ref: The port reference.
+ *   @iface: The port interface.
+ *   &returns: The implementation.
+ */
 
-	if(output.ref == io_stdout.ref)
-		impl->output = STDOUT_FILENO;
+_export
+struct scr_impl_t *scr_impl_openport(void *ref, const struct scr_port_i *iface)
+{
+	return impl_new(-1, -1, ref, iface);
+}
 
-	tcgetattr(impl->input, &impl->attr);
-	attr = impl->attr;
-	attr.c_lflag &= ~(ICANON | ECHO);
-	tcsetattr(impl->input, TCSANOW, &attr);
+/**
+ * Create an implementation.
+ *   @input: The input file descriptor.
+ *   @output: The output file descriptor.
+ *   @ref: The port reference.
+ *   @port: Optional. The port interface.
+ *   &returns: The implementation.
+ */
+
+static struct scr_impl_t *impl_new(int input, int output, void *ref, const struct scr_port_i *port)
+{
+	struct stat info;
+	struct termios attr;
+	struct scr_impl_t *impl;
+
+	impl = mem_alloc(sizeof(struct scr_impl_t));
+	impl->input = input;
+	impl->output = output;
+	impl->ref = ref;
+	impl->port = port;
+	impl->global = false;
+	impl->seqi = -1;
+	impl->out = NULL;
+	impl->len = impl->cap = 0;
+	impl->recv = impl->stamp = 0;
+	impl->stat = (struct scr_stat_t){ 0, 0 };
+	impl->fail = false;
+	impl->sock = (port == NULL) && (fstat(output, &info) == 0) && S_ISSOCK(info.st_mode);
+
+	impl->tty = (port == NULL) && (tcgetattr(impl->input, &impl->attr) == 0);
+	if(impl->tty) {
+		attr = impl->attr;
+		attr.c_lflag &= ~(ICANON | ECHO);
+		tcsetattr(impl->input, TCSANOW, &attr);
+	}
 
 	fdwrite(impl, "\x1B[?25l");
 	fdwrite(impl, "\x1B[?1049h");
+	fdflush(impl);
 	impl->buf = scr_buf_new((struct scr_box_t){ { 0 , 0 }, scr_impl_size(impl) });
 
-	impl_add(impl);
-
 	return impl;
 }
 
@@ -103,7 +186,10 @@ _export
 void scr_impl_close(struct scr_impl_t *impl)
 {
 	scr_buf_delete(impl->buf);
-	impl_remove(impl);
+
+	if(impl->global)
+		impl_remove(impl);
+
 	impl_delete(impl);
 }
 
@@ -114,11 +200,14 @@ void scr_impl_close(struct scr_impl_t *impl)
 
 static void impl_delete(struct scr_impl_t *impl)
 {
-	tcsetattr(impl->input, TCSANOW, &impl->attr);
+	if(impl->tty)
+		tcsetattr(impl->input, TCSANOW, &impl->attr);
 
 	fdwrite(impl, "\x1B[?25h");
 	fdwrite(impl, "\x1B[?1049l");
+	fdflush(impl);
 
+	mem_delete(impl->out);
 	mem_free(impl);
 }
 
@@ -144,6 +233,8 @@ int32_t scr_impl_read(struct scr_impl_t *impl, int timeout)
 	}
 
 	ch[0] = fdread(impl, timeout);
+	impl->stamp = impl->recv;
+
 	switch(ch[0]) {
 	case '\x1B':
 		ch[1] = fdread(impl, 10);
@@ -207,7 +298,11 @@ struct scr_size_t scr_impl_size(struct scr_impl_t *impl)
 {
 	struct winsize size;
 
-	ioctl(impl->output, TIOCGWINSZ, &size);
+	if(impl->port != NULL)
+		return impl->port->size(impl->ref);
+
+	if((ioctl(impl->output, TIOCGWINSZ, &size) < 0) || (size.ws_col == 0) || (size.ws_row == 0))
+		return (struct scr_size_t){ 80, 24 };
 
 	return (struct scr_size_t){ size.ws_col, size.ws_row };
 }
@@ -216,21 +311,28 @@ struct scr_size_t scr_impl_size(struct scr_impl_t *impl)
  * Swap buffers.
  *   @impl: The implementation.
  *   @buf: The new buffer.
+ *   &returns: The previous buffer, now owned by the caller.
  */
 
 _export
-void scr_impl_swap(struct scr_impl_t *impl, struct scr_buf_t *buf)
+struct scr_buf_t *scr_impl_swap(struct scr_impl_t *impl, struct scr_buf_t *buf)
 {
+	struct scr_buf_t *old;
 	unsigned int x, y;
 	struct scr_pt_t newpt, oldpt;
 	bool skipmove = false, bold = false, underline = false, neg = false;
-	unsigned short fg = scr_white_e, bg = scr_black_e;
+	unsigned short fg = scr_default_e, bg = scr_default_e;
 	struct scr_size_t size = buf->box.size;
 
 	fdwrite(impl, "\x1B[39;49m");
 	fdwrite(impl, "\x1B[0m");
 
 	for(y = 0; y < size.height; y++) {
+		if(row_isequal(buf, impl->buf, y)) {
+			skipmove = false;
+			continue;
+		}
+
 		for(x = 0; x < size.width; x++) {
 			newpt = scr_buf_get(buf, (struct scr_coord_t){ x, y });
 			oldpt = scr_buf_get(impl->buf, (struct scr_coord_t){ x, y });
@@ -273,8 +375,76 @@ void scr_impl_swap(struct scr_impl_t *impl, struct scr_buf_t *buf)
 		}
 	}
 
-	scr_buf_delete(impl->buf);
+	fdflush(impl);
+
+	old = impl->buf;
 	impl->buf = buf;
+
+	return old;
+}
+
+/**
+ * Determine if a row is equal in two buffers, comparing whole rows or
+ * planes at once. Rows of different layouts are never considered equal.
+ *   @a: The first buffer.
+ *   @b: The second buffer.
+ *   @y: The row.
+ *   &returns: True if definitely equal, false otherwise.
+ */
+
+static bool row_isequal(struct scr_buf_t *a, struct scr_buf_t *b, unsigned int y)
+{
+	size_t off, width = a->box.size.width;
+
+	if((width != b->box.size.width) || (y >= b->box.size.height))
+		return false;
+
+	off = (size_t)y * width;
+
+	if(scr_buf_isplane(a) && scr_buf_isplane(b))
+		return (memcmp(a->code + off, b->code + off, width * sizeof(uint32_t)) == 0) && (memcmp(a->attr + off, b->attr + off, width * sizeof(uint16_t)) == 0);
+	else if(scr_buf_isplane(a) || scr_buf_isplane(b))
+		return false;
+	else if(!scr_buf_live(a, y) || !scr_buf_live(b, y))
+		return !scr_buf_live(a, y) && !scr_buf_live(b, y);
+	else
+		return memcmp(a->pt + off, b->pt + off, width * sizeof(struct scr_pt_t)) == 0;
+}
+
+/**
+ * Retrieve the output statistics.
+ *   @impl: The implementation.
+ *   &returns: The statistics.
+ */
+
+_export
+struct scr_stat_t scr_impl_stat(struct scr_impl_t *impl)
+{
+	return impl->stat;
+}
+
+/**
+ * Check if the output has failed.
+ *   @impl: The implementation.
+ *   &returns: True if a write errored or stalled.
+ */
+
+_export
+bool scr_impl_failed(struct scr_impl_t *impl)
+{
+	return impl->fail;
+}
+
+/**
+ * Retrieve the time when the first byte of the last event was received.
+ *   @impl: The implementation.
+ *   &returns: The monotonic time in nanoseconds.
+ */
+
+_export
+uint64_t scr_impl_stamp(struct scr_impl_t *impl)
+{
+	return impl->stamp;
 }
 
 
@@ -287,52 +457,114 @@ void scr_impl_swap(struct scr_impl_t *impl, struct scr_buf_t *buf)
 
 static int16_t fdread(struct scr_impl_t *impl, int timeout)
 {
+	int byte;
 	char ch;
 	struct pollfd fds[1];
 
-	fds[0].fd = STDIN_FILENO;
+	if(impl->port != NULL) {
+		byte = impl->port->read(impl->ref, timeout);
+		if(byte < 0)
+			return '\0';
+
+		impl->recv = scr_lat_now();
+
+		return (char)byte;
+	}
+
+	fds[0].fd = impl->input;
 	fds[0].events = POLLIN;
 	fds[0].revents = 0;
 
 	if(poll(fds, 1, timeout) < 1)
 		return '\0';
 
-	if(read(impl->input, &ch, 1) < 0)
+	if(read(impl->input, &ch, 1) <= 0)
 		return '\0';
-	else
-		return ch;
+
+	impl->recv = scr_lat_now();
+
+	return ch;
 }
 
 /**
- * Write the string.
+ * Write the string to the pending output.
  *   @impl: The implementation.
  *   @str: The string.
  */
 
 static void fdwrite(struct scr_impl_t *impl, const char *restrict format, ...)
 {
-	size_t rem;
-	ssize_t ret;
+	size_t len;
 	va_list args;
 
 	va_start(args, format);
-	rem = str_vlprintf(format, args);
+	len = str_vlprintf(format, args);
 	va_end(args);
 
-	{
-		char str[rem + 1], *ptr = str;
+	if((impl->len + len + 1) > impl->cap) {
+		impl->cap = 2 * (impl->len + len + 1);
+		impl->out = mem_realloc(impl->out, impl->cap);
+	}
+
+	va_start(args, format);
+	str_vprintf(impl->out + impl->len, format, args);
+	va_end(args);
 
-		va_start(args, format);
-		str_vprintf(str, format, args);
-		va_end(args);
+	impl->len += len;
+}
 
-		while(rem > 0) {
-			ret = write(impl->output, ptr, rem);
+/**
+ * Flush the pending output to the port or file descriptor, waiting if the
+ * descriptor is non-blocking. Sockets are written without raising 'SIGPIPE'
+ * once the peer has closed, other descriptors leave it to the caller. A write
+ * error or a wait longer than 'IMPL_STALL' milliseconds marks the output as
+ * failed, and all later output is discarded.
+ *   @impl: The implementation.
+ */
 
-			rem -= ret;
+static void fdflush(struct scr_impl_t *impl)
+{
+	ssize_t ret;
+	struct pollfd fds[1];
+	char *ptr = impl->out;
+
+	if((impl->port != NULL) && (impl->len > 0)) {
+		impl->port->write(impl->ref, impl->out, impl->len);
+		impl->stat.bytes += impl->len;
+		impl->stat.writes++;
+		impl->len = 0;
+	}
+
+	while((impl->len > 0) && !impl->fail) {
+		if(impl->sock)
+			ret = send(impl->output, ptr, impl->len, MSG_NOSIGNAL);
+		else
+			ret = write(impl->output, ptr, impl->len);
+
+		impl->stat.writes++;
+
+		if(ret < 0) {
+			if(errno == EINTR)
+				continue;
+			else if(errno != EAGAIN) {
+				impl->fail = true;
+				break;
+			}
+
+			fds[0].fd = impl->output;
+			fds[0].events = POLLOUT;
+			fds[0].revents = 0;
+			if(poll(fds, 1, IMPL_STALL) == 0)
+				impl->fail = true;
+		}
+		else {
+			impl->stat.bytes += ret;
+			impl->len -= ret;
 			ptr += ret;
 		}
 	}
+
+	impl->len = 0;
 }
 
 
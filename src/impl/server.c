@@ -0,0 +1,324 @@
+#include "../common.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "../buf.h"
+#include "../lat.h"
+#include "../scr.h"
+#include "../server.h"
+
+
+/*
+ * server definitions
+ */
+
+#define SERVER_BATCH  4
+#define SERVER_EVENTS (EPOLLIN | EPOLLRDHUP | EPOLLONESHOT)
+
+/**
+ * Session structure.
+ *   @scr: The screen.
+ *   @input: The input file descriptor.
+ *   @ref: The reference.
+ *   @iface: The interface.
+ *   @prev, next: The previous and next sessions.
+ */
+
+struct scr_session_t {
+	struct scr_t *scr;
+	int input;
+
+	void *ref;
+	const struct scr_session_i *iface;
+
+	struct scr_session_t *prev, *next;
+};
+
+/**
+ * Server structure.
+ *   @epoll, wake: The epoll and wake file descriptors.
+ *   @nworkers: The number of workers.
+ *   @stop: The stop flag.
+ *   @lock: The session list lock, only taken to add or remove sessions.
+ *   @head: The session list.
+ */
+
+struct scr_server_t {
+	int epoll, wake;
+	unsigned int nworkers;
+	bool stop;
+
+	pthread_mutex_t lock;
+	struct scr_session_t *head;
+};
+
+
+/*
+ * local function declarations
+ */
+
+static void *server_worker(void *arg);
+
+static void session_proc(struct scr_server_t *server, struct scr_session_t *session, uint32_t events);
+static bool session_render(struct scr_session_t *session);
+static void session_close(struct scr_server_t *server, struct scr_session_t *session);
+
+
+/**
+ * Create a server. Socket sessions never raise 'SIGPIPE' once closed by the
+ * peer; sessions writing to pipes leave its handling to the caller.
+ *   @nworkers: The number of worker threads, including the running thread.
+ *   &returns: The server.
+ */
+
+_export
+struct scr_server_t *scr_server_new(unsigned int nworkers)
+{
+	struct scr_server_t *server;
+	struct epoll_event event;
+
+	server = mem_alloc(sizeof(struct scr_server_t));
+	server->nworkers = nworkers ?: 1;
+	server->stop = false;
+	server->head = NULL;
+	pthread_mutex_init(&server->lock, NULL);
+
+	server->epoll = epoll_create1(EPOLL_CLOEXEC);
+	if(server->epoll < 0)
+		_fatal("Failed to create epoll instance.");
+
+	server->wake = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if(server->wake < 0)
+		_fatal("Failed to create event descriptor.");
+
+	event.events = EPOLLIN;
+	event.data.ptr = NULL;
+	epoll_ctl(server->epoll, EPOLL_CTL_ADD, server->wake, &event);
+
+	return server;
+}
+
+/**
+ * Delete a server, closing all sessions. The server must not be running.
+ *   @server: The server.
+ */
+
+_export
+void scr_server_delete(struct scr_server_t *server)
+{
+	while(server->head != NULL)
+		session_close(server, server->head);
+
+	close(server->wake);
+	close(server->epoll);
+	pthread_mutex_destroy(&server->lock);
+	mem_free(server);
+}
+
+
+/**
+ * Run the server on the calling thread and the worker pool until stopped.
+ *   @server: The server.
+ */
+
+_export
+void scr_server_run(struct scr_server_t *server)
+{
+	uint64_t val;
+	unsigned int i;
+	pthread_t thread[server->nworkers];
+
+	for(i = 1; i < server->nworkers; i++)
+		pthread_create(&thread[i], NULL, server_worker, server);
+
+	server_worker(server);
+
+	for(i = 1; i < server->nworkers; i++)
+		pthread_join(thread[i], NULL);
+
+	while(read(server->wake, &val, sizeof(val)) > 0);
+
+	__atomic_store_n(&server->stop, false, __ATOMIC_RELEASE);
+}
+
+/**
+ * Stop a running server. Safe to call from any thread.
+ *   @server: The server.
+ */
+
+_export
+void scr_server_stop(struct scr_server_t *server)
+{
+	uint64_t val = 1;
+
+	__atomic_store_n(&server->stop, true, __ATOMIC_RELEASE);
+
+	if(write(server->wake, &val, sizeof(val)) < 0)
+		_fatal("Failed to wake server.");
+}
+
+/**
+ * Worker thread. Sessions are armed one-shot, so every ready session is
+ * delivered to exactly one worker until it is re-armed, and no lock is
+ * needed to process it. The wake descriptor is not drained by the workers,
+ * waking all of them once the server is stopped.
+ *   @arg: The server.
+ *   &returns: Always null.
+ */
+
+static void *server_worker(void *arg)
+{
+	int i, n;
+	struct scr_server_t *server = arg;
+	struct epoll_event event[SERVER_BATCH];
+
+	while(!__atomic_load_n(&server->stop, __ATOMIC_ACQUIRE)) {
+		n = epoll_wait(server->epoll, event, SERVER_BATCH, -1);
+
+		for(i = 0; i < n; i++) {
+			if(event[i].data.ptr != NULL)
+				session_proc(server, event[i].data.ptr, event[i].events);
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Add a session to the server. The session is rendered once before it is
+ * handed to the workers, and closed immediately if that frame fails.
+ *   @server: The server.
+ *   @input: The input file descriptor.
+ *   @output: The output file descriptor.
+ *   @ref: The reference.
+ *   @iface: The interface.
+ *   &returns: The session, or null if it was closed.
+ */
+
+_export
+struct scr_session_t *scr_server_add(struct scr_server_t *server, int input, int output, void *ref, const struct scr_session_i *iface)
+{
+	struct scr_session_t *session;
+	struct epoll_event event;
+
+	session = mem_alloc(sizeof(struct scr_session_t));
+	session->scr = scr_openfd(input, output);
+	session->input = input;
+	session->ref = ref;
+	session->iface = iface;
+	session->prev = NULL;
+
+	pthread_mutex_lock(&server->lock);
+	session->next = server->head;
+	if(server->head != NULL)
+		server->head->prev = session;
+
+	server->head = session;
+	pthread_mutex_unlock(&server->lock);
+
+	if(!session_render(session)) {
+		session_close(server, session);
+
+		return NULL;
+	}
+
+	event.events = SERVER_EVENTS;
+	event.data.ptr = session;
+	epoll_ctl(server->epoll, EPOLL_CTL_ADD, input, &event);
+
+	return session;
+}
+
+/**
+ * Retrieve the screen of a session.
+ *   @session: The session.
+ *   &returns: The screen.
+ */
+
+_export
+struct scr_t *scr_session_scr(struct scr_session_t *session)
+{
+	return session->scr;
+}
+
+
+/**
+ * Process a ready session, draining all pending input before rendering a
+ * single frame. Sessions that hang up or stall on output are closed.
+ *   @server: The server.
+ *   @session: The session.
+ *   @events: The epoll events.
+ */
+
+static void session_proc(struct scr_server_t *server, struct scr_session_t *session, uint32_t events)
+{
+	int32_t key;
+	struct epoll_event event;
+	bool open = !(events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR));
+
+	if(events & EPOLLIN) {
+		while((key = scr_read(session->scr, 0)) != 0) {
+			if(!session->iface->keypress(session->ref, key)) {
+				open = false;
+				break;
+			}
+		}
+	}
+
+	if(!open || !session_render(session)) {
+		session_close(server, session);
+
+		return;
+	}
+
+	event.events = SERVER_EVENTS;
+	event.data.ptr = session;
+	epoll_ctl(server->epoll, EPOLL_CTL_MOD, session->input, &event);
+}
+
+/**
+ * Render a frame of the session.
+ *   @session: The session.
+ *   &returns: True if the frame was written, false if the output failed.
+ */
+
+static bool session_render(struct scr_session_t *session)
+{
+	struct scr_buf_t *buf;
+
+	buf = scr_buf(session->scr);
+	session->iface->render(session->ref, scr_view_new(buf));
+	scr_swap(session->scr, buf);
+
+	return !scr_failed(session->scr);
+}
+
+/**
+ * Close a session and remove it from the server.
+ *   @server: The server.
+ *   @session: The session.
+ */
+
+static void session_close(struct scr_server_t *server, struct scr_session_t *session)
+{
+	epoll_ctl(server->epoll, EPOLL_CTL_DEL, session->input, NULL);
+
+	pthread_mutex_lock(&server->lock);
+	if(session->prev != NULL)
+		session->prev->next = session->next;
+	else
+		server->head = session->next;
+
+	if(session->next != NULL)
+		session->next->prev = session->prev;
+	pthread_mutex_unlock(&server->lock);
+
+	scr_close(session->scr);
+
+	if(session->iface->delete != NULL)
+		session->iface->delete(session->ref);
+
+	mem_free(session);
+}
@@ -0,0 +1,106 @@
+#include "common.h"
+#include <time.h>
+#include "lat.h"
+
+
+/**
+ * Retrieve the monotonic time.
+ *   &returns: The time in nanoseconds.
+ */
+
+uint64_t scr_lat_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+/**
+ * Initialize a histogram.
+ *   @hist: The histogram.
+ */
+
+void scr_hist_init(struct scr_hist_t *hist)
+{
+	unsigned int i;
+
+	hist->count = 0;
+	hist->max = 0;
+
+	for(i = 0; i < SCR_HIST_LEN; i++)
+		hist->bucket[i] = 0;
+}
+
+/**
+ * Add a sample to the histogram. Values below '2^SCR_HIST_SUB' are exact,
+ * larger values keep 'SCR_HIST_SUB' bits of precision.
+ *   @hist: The histogram.
+ *   @val: The value.
+ */
+
+void scr_hist_add(struct scr_hist_t *hist, uint64_t val)
+{
+	unsigned int idx, shift;
+
+	if(val < (1 << SCR_HIST_SUB))
+		idx = val;
+	else {
+		shift = 63 - __builtin_clzll(val) - SCR_HIST_SUB;
+		idx = ((shift + 1) << SCR_HIST_SUB) + ((val >> shift) & ((1 << SCR_HIST_SUB) - 1));
+	}
+
+	hist->bucket[idx]++;
+	hist->count++;
+
+	if(hist->max < val)
+		hist->max = val;
+}
+
+/**
+ * Compute a percentile from the histogram.
+ *   @hist: The histogram.
+ *   @pct: The percentile, between 0 and 100.
+ *   &returns: The upper bound of the percentile's bucket.
+ */
+
+uint64_t scr_hist_pct(const struct scr_hist_t *hist, unsigned int pct)
+{
+	unsigned int idx, shift;
+	uint64_t sum = 0, target, val;
+
+	if(hist->count == 0)
+		return 0;
+
+	target = (hist->count * pct + 99) / 100;
+	if(target == 0)
+		target = 1;
+
+	for(idx = 0; idx < SCR_HIST_LEN; idx++) {
+		sum += hist->bucket[idx];
+		if(sum >= target)
+			break;
+	}
+
+	if(idx < (1 << SCR_HIST_SUB))
+		val = idx;
+	else {
+		shift = (idx >> SCR_HIST_SUB) - 1;
+		val = ((((uint64_t)1 << SCR_HIST_SUB) + (idx & ((1 << SCR_HIST_SUB) - 1)) + 1) << shift) - 1;
+	}
+
+	return (val < hist->max) ? val : hist->max;
+}
+
+/**
+ * Summarize a histogram.
+ *   @hist: The histogram.
+ *   &returns: The latency summary.
+ */
+
+struct scr_lat_t scr_hist_sum(const struct scr_hist_t *hist)
+{
+	return (struct scr_lat_t){ hist->count, scr_hist_pct(hist, 50), scr_hist_pct(hist, 99), hist->max };
+}
@@ -0,0 +1,77 @@
+#ifndef LAT_H
+#define LAT_H
+
+/*
+ * start header: scr.h
+ */
+
+/* %scr.h% */
+
+/**
+ * Latency stage enumerator.
+ *   @scr_lat_input_e: Input parsing, from the first byte to the parsed key.
+ *   @scr_lat_logic_e: Widget logic, from the parsed key to the render start.
+ *   @scr_lat_render_e: Rendering, from the render start to the swap.
+ *   @scr_lat_write_e: Terminal write, the diff and write of the frame.
+ *   @scr_lat_total_e: Key-to-photon, from the first byte to the written frame.
+ *   @scr_lat_n: The number of stages.
+ */
+
+enum scr_lat_e {
+	scr_lat_input_e,
+	scr_lat_logic_e,
+	scr_lat_render_e,
+	scr_lat_write_e,
+	scr_lat_total_e,
+	scr_lat_n
+};
+
+/**
+ * Latency summary structure. All times are in nanoseconds.
+ *   @count: The number of samples.
+ *   @p50, p99: The 50th and 99th percentiles.
+ *   @max: The maximum.
+ */
+
+struct scr_lat_t {
+	uint64_t count;
+	uint64_t p50, p99, max;
+};
+
+/* %~scr.h% */
+
+/*
+ * end header: scr.h
+ */
+
+
+/*
+ * histogram definitions
+ */
+
+#define SCR_HIST_SUB  3
+#define SCR_HIST_LEN  ((64 - SCR_HIST_SUB + 1) << SCR_HIST_SUB)
+
+/**
+ * Log-linear histogram structure.
+ *   @count, max: The sample count and maximum.
+ *   @bucket: The bucket counts.
+ */
+
+struct scr_hist_t {
+	uint64_t count, max;
+	uint64_t bucket[SCR_HIST_LEN];
+};
+
+/*
+ * latency function declarations
+ */
+
+uint64_t scr_lat_now(void);
+
+void scr_hist_init(struct scr_hist_t *hist);
+void scr_hist_add(struct scr_hist_t *hist, uint64_t val);
+uint64_t scr_hist_pct(const struct scr_hist_t *hist, unsigned int pct);
+struct scr_lat_t scr_hist_sum(const struct scr_hist_t *hist);
+
+#endif
@@ -0,0 +1,270 @@
+#include "common.h"
+#include <string.h>
+#include "layer.h"
+#include "buf.h"
+#include "output.h"
+
+
+/**
+ * Layer structure.
+ *   @buf: The buffer.
+ *   @damage: The damaged region since the last composite.
+ *   @extent: The region holding content since the last clear.
+ */
+
+struct layer_t {
+	struct scr_buf_t *buf;
+	struct scr_box_t damage, extent;
+};
+
+/**
+ * Compositor structure.
+ *   @size: The size.
+ *   @layer: The layer stack.
+ *   @out: The composited output.
+ */
+
+struct scr_comp_t {
+	struct scr_size_t size;
+	struct layer_t layer[scr_layer_n];
+
+	struct scr_buf_t *out;
+};
+
+
+/*
+ * local function declarations
+ */
+
+static struct scr_box_t box_union(struct scr_box_t a, struct scr_box_t b);
+static struct scr_box_t box_clip(struct scr_box_t box, struct scr_size_t size);
+
+/*
+ * local variables
+ */
+
+static const struct scr_box_t box_empty = { { 0, 0 }, { 0, 0 } };
+static const struct scr_pt_t pt_none = { '\0', { scr_default_e, scr_default_e, false, false, false } };
+
+
+/**
+ * Create a compositor.
+ *   &returns: The compositor.
+ */
+
+_export
+struct scr_comp_t *scr_comp_new(void)
+{
+	unsigned int i;
+	struct scr_comp_t *comp;
+
+	comp = mem_alloc(sizeof(struct scr_comp_t));
+	comp->size = (struct scr_size_t){ 0, 0 };
+	comp->out = scr_buf_new(box_empty);
+
+	for(i = 0; i < scr_layer_n; i++)
+		comp->layer[i] = (struct layer_t){ scr_buf_new(box_empty), box_empty, box_empty };
+
+	return comp;
+}
+
+/**
+ * Delete a compositor.
+ *   @comp: The compositor.
+ */
+
+_export
+void scr_comp_delete(struct scr_comp_t *comp)
+{
+	unsigned int i;
+
+	for(i = 0; i < scr_layer_n; i++)
+		scr_buf_delete(comp->layer[i].buf);
+
+	scr_buf_delete(comp->out);
+	mem_free(comp);
+}
+
+
+/**
+ * Resize the compositor, discarding the content of every layer.
+ *   @comp: The compositor.
+ *   @size: The new size.
+ *   &returns: True if the size changed and all layers must be redrawn.
+ */
+
+_export
+bool scr_comp_resize(struct scr_comp_t *comp, struct scr_size_t size)
+{
+	unsigned int i;
+	struct scr_box_t box = { { 0, 0 }, size };
+
+	if((comp->size.width == size.width) && (comp->size.height == size.height))
+		return false;
+
+	comp->size = size;
+	scr_buf_replace(&comp->out, scr_buf_new(box));
+
+	for(i = 0; i < scr_layer_n; i++) {
+		scr_buf_replace(&comp->layer[i].buf, scr_buf_new(box));
+		comp->layer[i].damage = box;
+		comp->layer[i].extent = box_empty;
+
+		if(i != scr_layer_base_e)
+			scr_view_fill(scr_comp_view(comp, i), pt_none);
+	}
+
+	return true;
+}
+
+/**
+ * Retrieve a view over a layer.
+ *   @comp: The compositor.
+ *   @layer: The layer.
+ *   &returns: The view.
+ */
+
+_export
+struct scr_view_t scr_comp_view(struct scr_comp_t *comp, enum scr_layer_e layer)
+{
+	return (struct scr_view_t){ comp->layer[layer].buf, { { 0, 0 }, comp->size } };
+}
+
+
+/**
+ * Clear a layer. The base layer is cleared to blank and damaged entirely,
+ * upper layers become transparent where they held content.
+ *   @comp: The compositor.
+ *   @layer: The layer.
+ */
+
+_export
+void scr_comp_clear(struct scr_comp_t *comp, enum scr_layer_e layer)
+{
+	struct layer_t *inst = &comp->layer[layer];
+
+	if(layer == scr_layer_base_e) {
+		scr_view_fill(scr_comp_view(comp, layer), scr_pt_blank);
+		inst->damage = (struct scr_box_t){ { 0, 0 }, comp->size };
+	}
+	else {
+		scr_view_fill((struct scr_view_t){ inst->buf, inst->extent }, pt_none);
+		inst->damage = box_union(inst->damage, inst->extent);
+	}
+
+	inst->extent = box_empty;
+}
+
+/**
+ * Mark a region of a layer as damaged.
+ *   @comp: The compositor.
+ *   @layer: The layer.
+ *   @box: The damaged box in layer coordinates.
+ */
+
+_export
+void scr_comp_damage(struct scr_comp_t *comp, enum scr_layer_e layer, struct scr_box_t box)
+{
+	struct layer_t *inst = &comp->layer[layer];
+
+	box = box_clip(box, comp->size);
+	inst->damage = box_union(inst->damage, box);
+	inst->extent = box_union(inst->extent, box);
+}
+
+/**
+ * Composite the damaged regions of all layers and draw the result onto a
+ * view. Only damaged rows and columns are recomputed; upper layers are
+ * transparent wherever their code is zero.
+ *   @comp: The compositor.
+ *   @view: The target view.
+ */
+
+_export
+void scr_comp_render(struct scr_comp_t *comp, struct scr_view_t view)
+{
+	unsigned int i, x, y;
+	struct scr_box_t damage = box_empty;
+	struct scr_pt_t *restrict out;
+	const struct scr_pt_t *restrict in;
+
+	for(i = 0; i < scr_layer_n; i++)
+		damage = box_union(damage, comp->layer[i].damage);
+
+	for(y = 0; y < damage.size.height; y++) {
+		out = scr_clip_row(comp->out, damage, y);
+		in = scr_clip_row(comp->layer[scr_layer_base_e].buf, damage, y);
+		memcpy(out, in, damage.size.width * sizeof(struct scr_pt_t));
+
+		for(i = scr_layer_base_e + 1; i < scr_layer_n; i++) {
+			struct scr_box_t extent = comp->layer[i].extent;
+
+			if(!scr_box_inside(extent, (struct scr_coord_t){ extent.coord.x, damage.coord.y + y }))
+				continue;
+
+			in = scr_clip_row(comp->layer[i].buf, damage, y);
+			for(x = 0; x < damage.size.width; x++) {
+				if(in[x].code != '\0')
+					out[x] = in[x];
+			}
+		}
+	}
+
+	for(i = 0; i < scr_layer_n; i++)
+		comp->layer[i].damage = box_empty;
+
+	scr_blit(view, comp->out);
+}
+
+
+/**
+ * Compute the bounding box of two boxes.
+ *   @a: The first box.
+ *   @b: The second box.
+ *   &returns: The union.
+ */
+
+static struct scr_box_t box_union(struct scr_box_t a, struct scr_box_t b)
+{
+	int left, top, right, bottom;
+
+	if((a.size.width == 0) || (a.size.height == 0))
+		return b;
+	else if((b.size.width == 0) || (b.size.height == 0))
+		return a;
+
+	left = (a.coord.x < b.coord.x) ? a.coord.x : b.coord.x;
+	top = (a.coord.y < b.coord.y) ? a.coord.y : b.coord.y;
+	right = ((a.coord.x + (int)a.size.width) > (b.coord.x + (int)b.size.width)) ? (a.coord.x + (int)a.size.width) : (b.coord.x + (int)b.size.width);
+	bottom = ((a.coord.y + (int)a.size.height) > (b.coord.y + (int)b.size.height)) ? (a.coord.y + (int)a.size.height) : (b.coord.y + (int)b.size.height);
+
+	return (struct scr_box_t){ { left, top }, { right - left, bottom - top } };
+}
+
+/**
+ * Clip a box to a size.
+ *   @box: The box.
+ *   @size: The size.
+ *   &returns: The clipped box, possibly empty.
+ */
+
+static struct scr_box_t box_clip(struct scr_box_t box, struct scr_size_t size)
+{
+	int left, top, right, bottom;
+
+	left = (box.coord.x > 0) ? box.coord.x : 0;
+	top = (box.coord.y > 0) ? box.coord.y : 0;
+	right = box.coord.x + (int)box.size.width;
+	bottom = box.coord.y + (int)box.size.height;
+
+	if(right > (int)size.width)
+		right = size.width;
+
+	if(bottom > (int)size.height)
+		bottom = size.height;
+
+	if((left >= right) || (top >= bottom))
+		return box_empty;
+
+	return (struct scr_box_t){ { left, top }, { right - left, bottom - top } };
+}
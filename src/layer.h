@@ -0,0 +1,53 @@
+#ifndef LAYER_H
+#define LAYER_H
+
+/*
+ * start header: scr.h
+ */
+
+/* %scr.h% */
+
+/*
+ * structure prototypes
+ */
+
+struct scr_comp_t;
+
+
+/**
+ * Layer enumerator, ordered from bottom to top.
+ *   @scr_layer_base_e: The base panes.
+ *   @scr_layer_popup_e: Overlays and popups.
+ *   @scr_layer_status_e: The status line.
+ *   @scr_layer_n: The number of layers.
+ */
+
+enum scr_layer_e {
+	scr_layer_base_e,
+	scr_layer_popup_e,
+	scr_layer_status_e,
+	scr_layer_n
+};
+
+
+/*
+ * compositor function declarations
+ */
+
+struct scr_comp_t *scr_comp_new(void);
+void scr_comp_delete(struct scr_comp_t *comp);
+
+bool scr_comp_resize(struct scr_comp_t *comp, struct scr_size_t size);
+struct scr_view_t scr_comp_view(struct scr_comp_t *comp, enum scr_layer_e layer);
+
+void scr_comp_clear(struct scr_comp_t *comp, enum scr_layer_e layer);
+void scr_comp_damage(struct scr_comp_t *comp, enum scr_layer_e layer, struct scr_box_t box);
+void scr_comp_render(struct scr_comp_t *comp, struct scr_view_t view);
+
+/* %~scr.h% */
+
+/*
+ * end header: scr.h
+ */
+
+#endif
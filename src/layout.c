@@ -0,0 +1,354 @@
+#include "common.h"
+#include "layout.h"
+#include "pack.h"
+
+
+/**
+ * Layout node structure.
+ *   @dir: The direction of the children.
+ *   @constraint: The constraint on the length within the parent.
+ *   @child, last, next: The first child, last child, and next sibling.
+ *   @box: The computed box.
+ *   @len, frozen: The length and flag used while solving.
+ */
+
+struct node_t {
+	enum scr_layout_e dir;
+	struct scr_constraint_t constraint;
+
+	unsigned int child, last, next;
+	struct scr_box_t box;
+
+	unsigned int len;
+	bool frozen;
+};
+
+/**
+ * Layout structure. Nodes are stored in creation order, so that parents
+ * always precede their children. Boxes are computed on demand and kept
+ * until the size or the tree changes.
+ *   @nnodes, cap: The number of nodes and capacity.
+ *   @node: The nodes, the first being the root.
+ *   @size: The size of the computed boxes.
+ *   @dirty: The dirty flag, set when the tree changes.
+ */
+
+struct scr_layout_t {
+	unsigned int nnodes, cap;
+	struct node_t *node;
+
+	struct scr_size_t size;
+	bool dirty;
+};
+
+
+/*
+ * local function declarations
+ */
+
+static unsigned int layout_node(struct scr_layout_t *layout, enum scr_layout_e dir, struct scr_constraint_t constraint);
+static void layout_solve(struct scr_layout_t *layout, struct node_t *node);
+static void layout_flex(struct scr_layout_t *layout, struct node_t *node, unsigned int rem);
+
+/*
+ * local variables
+ */
+
+#define LAYOUT_NONE UINT_MAX
+
+
+/**
+ * Clamp a length to the bounds of a constraint.
+ *   @len: The length.
+ *   @constraint: The constraint.
+ *   &returns: The clamped length.
+ */
+
+static inline unsigned int layout_clamp(unsigned int len, struct scr_constraint_t constraint)
+{
+	if(len < constraint.min)
+		len = constraint.min;
+
+	if(len > constraint.max)
+		len = constraint.max;
+
+	return len;
+}
+
+
+/**
+ * Create a layout with a root node covering the whole size.
+ *   @dir: The direction of the root children.
+ *   &returns: The layout.
+ */
+
+_export
+struct scr_layout_t *scr_layout_new(enum scr_layout_e dir)
+{
+	struct scr_layout_t *layout;
+
+	layout = mem_alloc(sizeof(struct scr_layout_t));
+	layout->nnodes = layout->cap = 0;
+	layout->node = NULL;
+	layout->size = (struct scr_size_t){ 0, 0 };
+	layout->dirty = true;
+
+	layout_node(layout, dir, scr_flex(1.0));
+
+	return layout;
+}
+
+/**
+ * Delete a layout.
+ *   @layout: The layout.
+ */
+
+_export
+void scr_layout_delete(struct scr_layout_t *layout)
+{
+	mem_free(layout->node);
+	mem_free(layout);
+}
+
+
+/**
+ * Add a node to the layout, after the existing children of the parent.
+ *   @layout: The layout.
+ *   @parent: The parent node, zero for the root.
+ *   @dir: The direction of the children of the new node.
+ *   @constraint: The constraint on the length along the parent direction.
+ *   &returns: The new node.
+ */
+
+_export
+unsigned int scr_layout_add(struct scr_layout_t *layout, unsigned int parent, enum scr_layout_e dir, struct scr_constraint_t constraint)
+{
+	unsigned int node;
+	struct node_t *ptr;
+
+	if(parent >= layout->nnodes)
+		_fatal("Invalid layout node %u.", parent);
+
+	node = layout_node(layout, dir, constraint);
+	ptr = &layout->node[parent];
+
+	if(ptr->last == LAYOUT_NONE)
+		ptr->child = node;
+	else
+		layout->node[ptr->last].next = node;
+
+	ptr->last = node;
+	layout->dirty = true;
+
+	return node;
+}
+
+/**
+ * Change the constraint of a node.
+ *   @layout: The layout.
+ *   @node: The node.
+ *   @constraint: The constraint.
+ */
+
+_export
+void scr_layout_set(struct scr_layout_t *layout, unsigned int node, struct scr_constraint_t constraint)
+{
+	struct scr_constraint_t *cur;
+
+	if(node >= layout->nnodes)
+		_fatal("Invalid layout node %u.", node);
+
+	cur = &layout->node[node].constraint;
+	if((cur->type == constraint.type) && (cur->val == constraint.val) && (cur->min == constraint.min) && (cur->max == constraint.max))
+		return;
+
+	*cur = constraint;
+	layout->dirty = true;
+}
+
+
+/**
+ * Retrieve the box of a node, computing the layout only if the size or
+ * the tree changed since the last computation.
+ *   @layout: The layout.
+ *   @size: The size of the root.
+ *   @node: The node.
+ *   &returns: The box, relative to the root.
+ */
+
+_export
+struct scr_box_t scr_layout_box(struct scr_layout_t *layout, struct scr_size_t size, unsigned int node)
+{
+	unsigned int i;
+
+	if(node >= layout->nnodes)
+		_fatal("Invalid layout node %u.", node);
+
+	if(layout->dirty || (layout->size.width != size.width) || (layout->size.height != size.height)) {
+		layout->node[0].box = (struct scr_box_t){ { 0, 0 }, size };
+
+		for(i = 0; i < layout->nnodes; i++)
+			layout_solve(layout, &layout->node[i]);
+
+		layout->size = size;
+		layout->dirty = false;
+	}
+
+	return layout->node[node].box;
+}
+
+/**
+ * Retrieve the view of a node within a view.
+ *   @layout: The layout.
+ *   @view: The view of the root.
+ *   @node: The node.
+ *   &returns: The view of the node.
+ */
+
+_export
+struct scr_view_t scr_layout_view(struct scr_layout_t *layout, struct scr_view_t view, unsigned int node)
+{
+	return scr_pack_sub(view, scr_layout_box(layout, view.box.size, node));
+}
+
+
+/**
+ * Append a node without a parent.
+ *   @layout: The layout.
+ *   @dir: The direction of the children.
+ *   @constraint: The constraint.
+ *   &returns: The node.
+ */
+
+static unsigned int layout_node(struct scr_layout_t *layout, enum scr_layout_e dir, struct scr_constraint_t constraint)
+{
+	if(layout->nnodes == layout->cap) {
+		layout->cap = layout->cap ? (2 * layout->cap) : 8;
+		layout->node = mem_realloc(layout->node, layout->cap * sizeof(struct node_t));
+	}
+
+	layout->node[layout->nnodes] = (struct node_t){ dir, constraint, LAYOUT_NONE, LAYOUT_NONE, LAYOUT_NONE, { { 0, 0 }, { 0, 0 } }, 0, false };
+
+	return layout->nnodes++;
+}
+
+/**
+ * Compute the boxes of the children of a node. Fixed and ratio children
+ * are sized first, flexible children share the remainder, and children
+ * past the end of the node are truncated.
+ *   @layout: The layout.
+ *   @node: The node, its box already computed.
+ */
+
+static void layout_solve(struct scr_layout_t *layout, struct node_t *node)
+{
+	struct node_t *child;
+	unsigned int i, len, off, used = 0;
+	bool horiz = (node->dir == scr_layout_horiz_e);
+
+	if(node->child == LAYOUT_NONE)
+		return;
+
+	len = horiz ? node->box.size.width : node->box.size.height;
+
+	for(i = node->child; i != LAYOUT_NONE; i = child->next) {
+		child = &layout->node[i];
+		child->frozen = (child->constraint.type != scr_flex_e);
+
+		if(child->constraint.type == scr_fixed_e)
+			child->len = layout_clamp(child->constraint.val, child->constraint);
+		else if(child->constraint.type == scr_ratio_e)
+			child->len = layout_clamp(len * child->constraint.val, child->constraint);
+		else
+			continue;
+
+		used += child->len;
+	}
+
+	layout_flex(layout, node, (used < len) ? (len - used) : 0);
+
+	off = 0;
+
+	for(i = node->child; i != LAYOUT_NONE; i = child->next) {
+		child = &layout->node[i];
+		child->box = node->box;
+
+		if(child->len > len - off)
+			child->len = len - off;
+
+		if(horiz) {
+			child->box.coord.x += off;
+			child->box.size.width = child->len;
+		}
+		else {
+			child->box.coord.y += off;
+			child->box.size.height = child->len;
+		}
+
+		off += child->len;
+	}
+}
+
+/**
+ * Share the remaining length between the flexible children of a node by
+ * weight. Children whose share falls outside their bounds are fixed at the
+ * bound and the rest shared again.
+ *   @layout: The layout.
+ *   @node: The node.
+ *   @rem: The remaining length.
+ */
+
+static void layout_flex(struct scr_layout_t *layout, struct node_t *node, unsigned int rem)
+{
+	struct node_t *child;
+	unsigned int i, left, prev, end;
+	double weight, acc, share;
+	bool again;
+
+	do {
+		left = rem;
+		weight = 0.0;
+
+		for(i = node->child; i != LAYOUT_NONE; i = child->next) {
+			child = &layout->node[i];
+			if(child->constraint.type != scr_flex_e)
+				continue;
+
+			if(child->frozen)
+				left -= (child->len < left) ? child->len : left;
+			else
+				weight += child->constraint.val;
+		}
+
+		again = false;
+
+		for(i = node->child; i != LAYOUT_NONE; i = child->next) {
+			child = &layout->node[i];
+			if(child->frozen)
+				continue;
+
+			share = (weight > 0.0) ? (left * child->constraint.val / weight) : 0.0;
+			if((share < child->constraint.min) || (share > child->constraint.max)) {
+				child->len = layout_clamp(share, child->constraint);
+				child->frozen = again = true;
+			}
+		}
+	} while(again);
+
+	acc = 0.0;
+	prev = 0;
+
+	for(i = node->child; i != LAYOUT_NONE; i = child->next) {
+		child = &layout->node[i];
+		if(child->frozen)
+			continue;
+
+		acc += child->constraint.val;
+		if(weight <= 0.0)
+			end = 0;
+		else
+			end = (acc >= weight) ? left : (unsigned int)(left * acc / weight);
+		child->len = end - prev;
+		prev = end;
+	}
+}
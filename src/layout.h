@@ -0,0 +1,124 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+/*
+ * start header: scr.h
+ */
+
+/* %scr.h% */
+
+/*
+ * structure prototypes
+ */
+
+struct scr_layout_t;
+
+
+/**
+ * Layout direction enumerator, the axis children are stacked along.
+ *   @scr_layout_horiz_e: Left to right.
+ *   @scr_layout_vert_e: Top to bottom.
+ */
+
+enum scr_layout_e {
+	scr_layout_horiz_e,
+	scr_layout_vert_e
+};
+
+/**
+ * Constraint type enumerator.
+ *   @scr_fixed_e: Fixed number of cells.
+ *   @scr_ratio_e: Ratio of the parent length.
+ *   @scr_flex_e: Share of the remaining length by weight.
+ */
+
+enum scr_constraint_e {
+	scr_fixed_e,
+	scr_ratio_e,
+	scr_flex_e
+};
+
+/**
+ * Constraint structure.
+ *   @type: The type.
+ *   @val: The cells, ratio, or weight.
+ *   @min, max: The bounds on the length.
+ */
+
+struct scr_constraint_t {
+	enum scr_constraint_e type;
+	double val;
+	unsigned int min, max;
+};
+
+
+/*
+ * layout function declarations
+ */
+
+struct scr_layout_t *scr_layout_new(enum scr_layout_e dir);
+void scr_layout_delete(struct scr_layout_t *layout);
+
+unsigned int scr_layout_add(struct scr_layout_t *layout, unsigned int parent, enum scr_layout_e dir, struct scr_constraint_t constraint);
+void scr_layout_set(struct scr_layout_t *layout, unsigned int node, struct scr_constraint_t constraint);
+
+struct scr_box_t scr_layout_box(struct scr_layout_t *layout, struct scr_size_t size, unsigned int node);
+struct scr_view_t scr_layout_view(struct scr_layout_t *layout, struct scr_view_t view, unsigned int node);
+
+
+/**
+ * Create a fixed constraint.
+ *   @len: The length in cells.
+ *   &returns: The constraint.
+ */
+
+static inline struct scr_constraint_t scr_fixed(unsigned int len)
+{
+	return (struct scr_constraint_t){ scr_fixed_e, len, 0, UINT_MAX };
+}
+
+/**
+ * Create a ratio constraint.
+ *   @ratio: The ratio of the parent length.
+ *   &returns: The constraint.
+ */
+
+static inline struct scr_constraint_t scr_ratio(double ratio)
+{
+	return (struct scr_constraint_t){ scr_ratio_e, ratio, 0, UINT_MAX };
+}
+
+/**
+ * Create a flexible constraint.
+ *   @weight: The weight of the share of remaining length.
+ *   &returns: The constraint.
+ */
+
+static inline struct scr_constraint_t scr_flex(double weight)
+{
+	return (struct scr_constraint_t){ scr_flex_e, weight, 0, UINT_MAX };
+}
+
+/**
+ * Bound the length of a constraint.
+ *   @constraint: The constraint.
+ *   @min: The minimum length.
+ *   @max: The maximum length.
+ *   &returns: The bounded constraint.
+ */
+
+static inline struct scr_constraint_t scr_bound(struct scr_constraint_t constraint, unsigned int min, unsigned int max)
+{
+	constraint.min = min;
+	constraint.max = max;
+
+	return constraint;
+}
+
+/* %~scr.h% */
+
+/*
+ * end header: scr.h
+ */
+
+#endif
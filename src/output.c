@@ -1,7 +1,12 @@
 #include "common.h"
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "output.h"
 #include "accum.h"
 #include "buf.h"
+#include "dlist.h"
 
 
 /*
@@ -9,6 +14,14 @@
  */
 
 static size_t output_write(void *ref, const void *buf, size_t nbytes);
+static size_t output_ascii(const uint8_t *restrict text, size_t nbytes, uint32_t *restrict run, size_t max);
+static size_t output_decode(const uint8_t *restrict text, size_t nbytes, uint32_t *code);
+static size_t output_skip(struct scr_output_t *output, const uint8_t *restrict text, size_t nbytes);
+static void output_run(struct scr_output_t *output, const uint32_t *code, size_t n);
+static inline void output_put(struct scr_output_t *output, struct scr_pt_t pt);
+static void output_char(struct scr_output_t *output, struct scr_pt_t pt);
+static void output_word(struct scr_output_t *output, struct scr_pt_t pt);
+static void output_reflow(struct scr_output_t *output, struct scr_buf_t *src);
 static bool output_ctrl(struct scr_output_t *output, unsigned int cmd, void *arg);
 
 static void bold_proc(struct io_output_t output, void *arg);
@@ -20,11 +33,17 @@ static void error_proc(struct io_output_t output, void *arg);
  * local variables
  */
 
+#define OUTPUT_RUN 64
+
 static const struct io_output_i output_iface = { { (io_ctrl_f)output_ctrl, NULL }, output_write };
 
 
 /**
- * Write data to the output.
+ * Write data to the output. Points are gathered into runs that are passed
+ * to the span function, unless word wrapping. Malformed UTF-8, including a
+ * sequence cut off by the end of the data, is output as U+FFFD. Writing
+ * stops once the output is exhausted, and without wrapping the rest of a
+ * line past the right edge is skipped.
  *   @output: Output.
  *   @buf: The buffer.
  *   @nbytes: The number of bytes.
@@ -33,48 +52,329 @@ static const struct io_output_i output_iface = { { (io_ctrl_f)output_ctrl, NULL
 _export
 void scr_output_write(struct scr_output_t *output, const void *restrict buf, size_t nbytes)
 {
-	const char *text = buf;
+	size_t n = 0, len;
+	uint32_t code, run[OUTPUT_RUN];
+	const uint8_t *text = buf;
+	bool word = (output->wrap == scr_wrap_word_e) && (output->width > 0);
 
-	switch(output->wrap) {
-	case scr_wrap_none_e:
-		while(nbytes > 0) {
-			if(*text == '\n') {
-				text++;
-				output->coord.x = 0;
-				output->coord.y++;
-				nbytes--;
+	while(nbytes > 0) {
+		if(scr_output_done(output))
+			break;
+
+		if((output->wrap == scr_wrap_none_e) && (output->coord.x < (int64_t)output->offset)) {
+			output_run(output, run, n);
+			n = 0;
+
+			len = output_skip(output, text, nbytes);
+			text += len;
+			nbytes -= len;
+
+			if(nbytes == 0)
+				break;
+		}
+
+		if((output->wrap == scr_wrap_none_e) && ((output->coord.x - (int64_t)output->offset + n) >= output->limit.x)) {
+			const uint8_t *nl;
+
+			output_run(output, run, n);
+			n = 0;
+
+			nl = memchr(text, '\n', nbytes);
+			if(nl == NULL)
+				break;
+
+			nbytes -= nl - text;
+			text = nl;
+		}
+
+		if(!word) {
+			len = output_ascii(text, nbytes, run + n, OUTPUT_RUN - n);
+			text += len;
+			nbytes -= len;
+			n += len;
+
+			if(n == OUTPUT_RUN) {
+				output_run(output, run, n);
+				n = 0;
+
+				continue;
 			}
-			else if((uint8_t)*text >= 0x80) {
-				uint8_t len;
-				uint32_t code;
-				uint8_t val = (uint8_t)(*text++);
+			else if(nbytes == 0)
+				break;
+		}
 
-				len = m_uintclz(~val << (8 * (sizeof(unsigned int) - 1)));
-				code = val & ~(((1 << len) - 1) << (8 - len));
+		len = output_decode(text, nbytes, &code);
+		text += len;
+		nbytes -= len;
 
-				nbytes -= len;
-				for(len--; len > 0; len--)
-					code = (code << 6) | ((uint8_t)(*text++) & 0x3F);
+		if(code == '\n') {
+			output_run(output, run, n);
+			n = 0;
 
-				output->func(output->coord, (struct scr_pt_t){ code, output->prop }, output->arg);
-				output->coord.x++;
+			scr_output_flush(output);
+			output->coord.x = 0;
+			output->coord.y++;
+		}
+		else if(word)
+			output_word(output, (struct scr_pt_t){ code, output->prop });
+		else {
+			run[n++] = code;
+
+			if(n == OUTPUT_RUN) {
+				output_run(output, run, n);
+				n = 0;
 			}
-			else {
-				uint8_t val = *text++;
+		}
+	}
+
+	output_run(output, run, n);
+}
+
+/**
+ * Flush the pending word of the output. Called at the end of every print,
+ * only needed after direct writes.
+ *   @output: The output.
+ */
+
+_export
+void scr_output_flush(struct scr_output_t *output)
+{
+	unsigned int i;
+
+	for(i = 0; i < output->npend; i++)
+		output_char(output, output->pend[i]);
+
+	output->npend = 0;
+}
+
+
+/**
+ * Widen a stretch of plain ASCII, stopping at a newline or any non-ASCII
+ * byte. Whole blocks of 16 bytes are checked at once when SSE2 is
+ * available.
+ *   @text: The text.
+ *   @nbytes: The number of bytes of text.
+ *   @run: Out. The codes.
+ *   @max: The maximum number of codes.
+ *   &returns: The number of bytes consumed.
+ */
+
+static size_t output_ascii(const uint8_t *restrict text, size_t nbytes, uint32_t *restrict run, size_t max)
+{
+	size_t i = 0;
+#ifdef __SSE2__
+	__m128i in, lo, hi, zero = _mm_setzero_si128(), nl = _mm_set1_epi8('\n');
+#endif
+
+	if(max > nbytes)
+		max = nbytes;
+
+#ifdef __SSE2__
+	while((i + 16) <= max) {
+		in = _mm_loadu_si128((const __m128i *)(text + i));
+		if(_mm_movemask_epi8(_mm_or_si128(in, _mm_cmpeq_epi8(in, nl))) != 0)
+			break;
+
+		lo = _mm_unpacklo_epi8(in, zero);
+		hi = _mm_unpackhi_epi8(in, zero);
+		_mm_storeu_si128((__m128i *)(run + i), _mm_unpacklo_epi16(lo, zero));
+		_mm_storeu_si128((__m128i *)(run + i + 4), _mm_unpackhi_epi16(lo, zero));
+		_mm_storeu_si128((__m128i *)(run + i + 8), _mm_unpacklo_epi16(hi, zero));
+		_mm_storeu_si128((__m128i *)(run + i + 12), _mm_unpackhi_epi16(hi, zero));
+		i += 16;
+	}
+#endif
+
+	while((i < max) && (text[i] < 0x80) && (text[i] != '\n')) {
+		run[i] = text[i];
+		i++;
+	}
+
+	return i;
+}
+
+/**
+ * Skip text before the horizontal scroll offset, stopping at a newline.
+ * Plain ASCII is skipped without decoding.
+ *   @output: The output.
+ *   @text: The text.
+ *   @nbytes: The number of bytes of text.
+ *   &returns: The number of bytes consumed.
+ */
+
+static size_t output_skip(struct scr_output_t *output, const uint8_t *restrict text, size_t nbytes)
+{
+	uint32_t code;
+	size_t i = 0;
+
+	while((output->coord.x < (int64_t)output->offset) && (i < nbytes) && (text[i] != '\n')) {
+		i += (text[i] < 0x80) ? 1 : output_decode(text + i, nbytes - i, &code);
+		output->coord.x++;
+	}
+
+	return i;
+}
+
+/**
+ * Decode a single UTF-8 sequence. Invalid lead bytes, bad or missing
+ * continuation bytes, overlong forms, surrogates, and codes past U+10FFFF
+ * all decode as U+FFFD. Only the bytes of a valid prefix are consumed, so
+ * decoding resynchronizes on the next byte.
+ *   @text: The text.
+ *   @nbytes: The number of bytes of text, non-zero.
+ *   @code: Out. The code.
+ *   &returns: The number of bytes consumed.
+ */
+
+static size_t output_decode(const uint8_t *restrict text, size_t nbytes, uint32_t *code)
+{
+	size_t i, len;
+	uint32_t val, min;
+
+	if(text[0] < 0x80) {
+		*code = text[0];
+
+		return 1;
+	}
+	else if((text[0] & 0xE0) == 0xC0)
+		len = 2, val = text[0] & 0x1F, min = 0x80;
+	else if((text[0] & 0xF0) == 0xE0)
+		len = 3, val = text[0] & 0x0F, min = 0x800;
+	else if((text[0] & 0xF8) == 0xF0)
+		len = 4, val = text[0] & 0x07, min = 0x10000;
+	else {
+		*code = 0xFFFD;
+
+		return 1;
+	}
+
+	for(i = 1; i < len; i++) {
+		if((i >= nbytes) || ((text[i] & 0xC0) != 0x80)) {
+			*code = 0xFFFD;
+
+			return i;
+		}
+
+		val = (val << 6) | (text[i] & 0x3F);
+	}
+
+	if((val < min) || (val > 0x10FFFF) || ((val >= 0xD800) && (val <= 0xDFFF)))
+		val = 0xFFFD;
+
+	*code = val;
+
+	return len;
+}
+
+/**
+ * Output a run of codes with the current property set and advance,
+ * breaking it on character when wrapping.
+ *   @output: The output.
+ *   @code: The codes.
+ *   @n: The number of codes.
+ */
+
+static void output_run(struct scr_output_t *output, const uint32_t *code, size_t n)
+{
+	size_t i, len;
+	struct scr_coord_t coord;
 
-				output->func(output->coord, (struct scr_pt_t){ val, output->prop }, output->arg);
-				//scr_view_set(output->view, output->coord, (struct scr_pt_t){ *text, output->prop });
+	while(n > 0) {
+		len = n;
 
-				output->coord.x++;
-				nbytes--;
+		if((output->wrap == scr_wrap_char_e) && (output->width > 0)) {
+			if(output->coord.x >= (int)output->width) {
+				output->coord.x = 0;
+				output->coord.y++;
 			}
+
+			if(len > (output->width - output->coord.x))
+				len = output->width - output->coord.x;
 		}
 
-		break;
+		if(output->wrap == scr_wrap_none_e)
+			coord = (struct scr_coord_t){ output->coord.x - output->offset, output->coord.y };
+		else
+			coord = output->coord;
+
+		if(output->span != NULL)
+			output->span(coord, code, len, output->prop, output->arg);
+		else {
+			for(i = 0; i < len; i++)
+				output->func((struct scr_coord_t){ coord.x + i, coord.y }, (struct scr_pt_t){ code[i], output->prop }, output->arg);
+		}
+
+		output->coord.x += len;
+
+		code += len;
+		n -= len;
+	}
+}
+
+/**
+ * Put a point at the current coordinates and advance.
+ *   @output: The output.
+ *   @pt: The point.
+ */
+
+static inline void output_put(struct scr_output_t *output, struct scr_pt_t pt)
+{
+	output->func(output->coord, pt, output->arg);
+	output->coord.x++;
+}
+
+/**
+ * Put a point, wrapping on character.
+ *   @output: The output.
+ *   @pt: The point.
+ */
+
+static void output_char(struct scr_output_t *output, struct scr_pt_t pt)
+{
+	if(output->coord.x >= (int)output->width) {
+		output->coord.x = 0;
+		output->coord.y++;
+	}
+
+	output_put(output, pt);
+}
+
+/**
+ * Put a point, wrapping on word. Word characters are held back until the
+ * word ends, at most 'SCR_OUTPUT_WORD' of them; longer words and words
+ * wider than a line are broken on character.
+ *   @output: The output.
+ *   @pt: The point.
+ */
 
-	default:
-		_fatal("stub, haven't implemented wrapping");
+static void output_word(struct scr_output_t *output, struct scr_pt_t pt)
+{
+	if(pt.code == ' ') {
+		scr_output_flush(output);
+
+		if(output->coord.x >= (int)output->width) {
+			output->coord.x = 0;
+			output->coord.y++;
+		}
+		else
+			output_put(output, pt);
+
+		return;
+	}
+
+	if((output->coord.x + output->npend) >= output->width) {
+		if((output->coord.x > 0) && (output->npend < output->width)) {
+			output->coord.x = 0;
+			output->coord.y++;
+		}
+		else
+			scr_output_flush(output);
 	}
+
+	if(output->npend == SCR_OUTPUT_WORD)
+		scr_output_flush(output);
+
+	output->pend[output->npend++] = pt;
 }
 
 
@@ -107,7 +407,24 @@ void scr_vprintf(struct scr_output_t *output, const char *restrict format, va_li
 {
 	struct io_output_t internal = { output, &output_iface };
 
+	if(scr_output_done(output))
+		return;
+
 	io_vprintf(internal, format, args);
+	scr_output_flush(output);
+}
+
+
+/**
+ * Retrieve a stream interface onto an output, used to process chunks.
+ *   @output: The output.
+ *   &returns: The stream output.
+ */
+
+_export
+struct io_output_t scr_output_io(struct scr_output_t *output)
+{
+	return (struct io_output_t){ output, &output_iface };
 }
 
 
@@ -123,6 +440,16 @@ static bool output_ctrl(struct scr_output_t *output, unsigned int cmd, void *arg
 	switch(cmd) {
 	case scr_propget_e: *(struct scr_prop_t *)arg = output->prop; break;
 	case scr_propset_e: output->prop = *(struct scr_prop_t *)arg; break;
+
+	case scr_skip_e:
+		if((output->wrap == scr_wrap_none_e) && (output->coord.x < (int64_t)output->offset))
+			*(unsigned int *)arg = output->offset - output->coord.x;
+		else
+			*(unsigned int *)arg = 0;
+
+		break;
+
+	case scr_seek_e: output->coord.x += *(unsigned int *)arg; break;
 	default: return false;
 	}
 
@@ -145,6 +472,35 @@ static size_t output_write(void *ref, const void *buf, size_t nbytes)
 }
 
 
+/**
+ * Retrieve the number of columns a chunk producer may skip. Producers that
+ * can seek cheaply advance their text by up to this many columns and then
+ * call 'scr_chunk_seek'.
+ *   @output: The output.
+ *   &returns: The number of columns, zero if nothing is being skipped.
+ */
+
+_export
+unsigned int scr_chunk_skip(struct io_output_t output)
+{
+	unsigned int ncols;
+
+	return io_output_ctrl(output, scr_skip_e, &ncols) ? ncols : 0;
+}
+
+/**
+ * Advance the output past columns skipped by a chunk producer.
+ *   @output: The output.
+ *   @ncols: The number of columns skipped.
+ */
+
+_export
+void scr_chunk_seek(struct io_output_t output, unsigned int ncols)
+{
+	io_output_ctrl(output, scr_seek_e, &ncols);
+}
+
+
 /**
  * Create a chunk for modifying the bold flag.
  *   @value: The bold flag.
@@ -260,6 +616,143 @@ static void error_proc(struct io_output_t output, void *arg)
 }
 
 
+/**
+ * Measure the extent of a chunk without storing any points.
+ *   @chunk: The chunk.
+ *   @width: The word wrapping width, zero for unlimited.
+ *   &returns: The bounding box of the points printed, empty if none.
+ */
+
+_export
+struct scr_box_t scr_measure(struct io_chunk_t chunk, unsigned int width)
+{
+	struct scr_box_t box = { { 0, 0 }, { 0, 0 } };
+	struct scr_output_t output = scr_output_measure(&box);
+
+	output.wrap = scr_wrap_word_e;
+	output.width = width;
+
+	scr_printf(&output, "%C", chunk);
+
+	return box;
+}
+
+/**
+ * Create a buffer holding a chunk. The chunk is measured first and then
+ * printed directly into a buffer of the exact size.
+ *   @chunk: The chunk.
+ *   @width: The word wrapping width, zero for unlimited.
+ *   &returns: The buffer, with the box of the printed points.
+ */
+
+_export
+struct scr_buf_t *scr_chunk_buf(struct io_chunk_t chunk, unsigned int width)
+{
+	struct scr_box_t box;
+	struct scr_buf_t *buf;
+	struct scr_view_t view;
+	struct scr_output_t output;
+
+	box = scr_measure(chunk, width);
+	buf = scr_buf_new(box);
+	view = (struct scr_view_t){ buf, { { 0, 0 }, { box.coord.x + box.size.width, box.coord.y + box.size.height } } };
+
+	output = scr_output_view(view);
+	output.wrap = scr_wrap_word_e;
+	output.width = width;
+	scr_printf(&output, "%C", chunk);
+
+	return buf;
+}
+
+/**
+ * Word wrap an unwrapped buffer, such as one from 'scr_chunk_buf' with no
+ * width, into a new buffer. Rows are taken as lines without their
+ * trailing blanks, and points keep their properties. Internal to the UI.
+ *   @src: The source buffer, of any layout.
+ *   @width: The word wrapping width, zero for unlimited.
+ *   &returns: The buffer, with the box of the printed points.
+ */
+
+struct scr_buf_t *scr_buf_wrap(struct scr_buf_t *src, unsigned int width)
+{
+	struct scr_box_t box = { { 0, 0 }, { 0, 0 } };
+	struct scr_buf_t *buf;
+	struct scr_view_t view;
+	struct scr_output_t output;
+
+	output = scr_output_measure(&box);
+	output.wrap = scr_wrap_word_e;
+	output.width = width;
+	output_reflow(&output, src);
+
+	buf = scr_buf_new(box);
+	view = (struct scr_view_t){ buf, { { 0, 0 }, { box.coord.x + box.size.width, box.coord.y + box.size.height } } };
+
+	output = scr_output_view(view);
+	output.wrap = scr_wrap_word_e;
+	output.width = width;
+	output_reflow(&output, src);
+
+	return buf;
+}
+
+/**
+ * Write the points of a buffer to an output, one row per line. Points are
+ * read through 'scr_buf_get', so plane and lazy buffers are read correctly.
+ *   @output: The output.
+ *   @src: The source buffer.
+ */
+
+static void output_reflow(struct scr_output_t *output, struct scr_buf_t *src)
+{
+	struct scr_pt_t pt;
+	struct scr_coord_t coord;
+	unsigned int x, y, n, w = src->box.size.width;
+	bool word = (output->wrap == scr_wrap_word_e) && (output->width > 0);
+
+	output->coord = src->box.coord;
+
+	for(y = 0; y < src->box.size.height; y++) {
+		coord = (struct scr_coord_t){ src->box.coord.x, src->box.coord.y + y };
+
+		for(n = w; n > 0; n--) {
+			if(!scr_pt_isequal(scr_buf_get(src, (struct scr_coord_t){ coord.x + n - 1, coord.y }), scr_pt_blank))
+				break;
+		}
+
+		for(x = 0; (x < n) && !scr_output_done(output); x++) {
+			pt = scr_buf_get(src, (struct scr_coord_t){ coord.x + x, coord.y });
+
+			if(word)
+				output_word(output, pt);
+			else
+				output_put(output, pt);
+		}
+
+		scr_output_flush(output);
+		output->coord.x = src->box.coord.x;
+		output->coord.y++;
+	}
+}
+
+/**
+ * Print a chunk into a view, word wrapped to the view width. Points outside
+ * the view are discarded.
+ *   @view: The view.
+ *   @chunk: The chunk.
+ */
+
+_export
+void scr_view_print(struct scr_view_t view, struct io_chunk_t chunk)
+{
+	struct scr_output_t output = scr_output_view(view);
+
+	output.wrap = scr_wrap_word_e;
+	scr_printf(&output, "%C", chunk);
+}
+
+
 /**
  * Fill a view with a point.
  *   @view: The view.
@@ -269,11 +762,21 @@ static void error_proc(struct io_output_t output, void *arg)
 _export
 void scr_view_fill(struct scr_view_t view, struct scr_pt_t pt)
 {
-	struct scr_coord_t coord;
+	unsigned int y;
+	struct scr_box_t clip;
+
+	if(!scr_view_clip(view, &clip))
+		return;
 
-	for(coord.y = 0; coord.y < view.box.size.height; coord.y++) {
-		for(coord.x = 0; coord.x < view.box.size.width; coord.x++)
-			scr_view_set(view, coord, pt);
+	if(scr_buf_isplane(view.buf)) {
+		for(y = 0; y < clip.size.height; y++) {
+			scr_plane_code(view.buf->code + scr_clip_index(view.buf, clip, y), clip.size.width, pt.code);
+			scr_plane_attr(view.buf->attr + scr_clip_index(view.buf, clip, y), clip.size.width, scr_prop_pack(pt.prop));
+		}
+	}
+	else {
+		for(y = 0; y < clip.size.height; y++)
+			scr_span_fill(scr_clip_row(view.buf, clip, y), clip.size.width, pt);
 	}
 }
 
@@ -286,11 +789,44 @@ void scr_view_fill(struct scr_view_t view, struct scr_pt_t pt)
 _export
 void scr_view_fill_code(struct scr_view_t view, uint32_t code)
 {
-	struct scr_coord_t coord;
+	unsigned int y;
+	struct scr_box_t clip;
+
+	if(!scr_view_clip(view, &clip))
+		return;
+
+	if(scr_buf_isplane(view.buf)) {
+		for(y = 0; y < clip.size.height; y++)
+			scr_plane_code(view.buf->code + scr_clip_index(view.buf, clip, y), clip.size.width, code);
+	}
+	else {
+		for(y = 0; y < clip.size.height; y++)
+			scr_span_code(scr_clip_row(view.buf, clip, y), clip.size.width, code);
+	}
+}
+
+/**
+ * Fill a view with a property set, keeping the codes.
+ *   @view: The view.
+ *   @prop: The property set.
+ */
+
+_export
+void scr_view_fill_prop(struct scr_view_t view, struct scr_prop_t prop)
+{
+	unsigned int y;
+	struct scr_box_t clip;
 
-	for(coord.y = 0; coord.y < view.box.size.height; coord.y++) {
-		for(coord.x = 0; coord.x < view.box.size.width; coord.x++)
-			scr_view_set_code(view, coord, code);
+	if(!scr_view_clip(view, &clip))
+		return;
+
+	if(scr_buf_isplane(view.buf)) {
+		for(y = 0; y < clip.size.height; y++)
+			scr_plane_attr(view.buf->attr + scr_clip_index(view.buf, clip, y), clip.size.width, scr_prop_pack(prop));
+	}
+	else {
+		for(y = 0; y < clip.size.height; y++)
+			scr_span_prop(scr_clip_row(view.buf, clip, y), clip.size.width, prop);
 	}
 }
 
@@ -326,6 +862,25 @@ void scr_render_fill(struct scr_render_t *render, char ch)
 	struct scr_box_t box = render->box;
 	struct scr_pt_t pt = { ch, render->prop };
 
+	if(render->func == scr_dlist_output) {
+		scr_dlist_fill(render->arg, (struct scr_box_t){ { 0, 0 }, box.size }, pt);
+
+		return;
+	}
+	else if(render->func == scr_view_output) {
+		struct scr_view_t view = *(struct scr_view_t *)render->arg;
+
+		if(view.box.size.width > box.size.width)
+			view.box.size.width = box.size.width;
+
+		if(view.box.size.height > box.size.height)
+			view.box.size.height = box.size.height;
+
+		scr_view_fill(view, pt);
+
+		return;
+	}
+
 	for(y = 0; y < box.size.height; y++) {
 		for(x = 0; x < box.size.width; x++)
 			render_pt(render, (struct scr_coord_t){ x, y }, pt);
@@ -345,6 +900,12 @@ void scr_render_border(struct scr_render_t *render, char ch)
 	struct scr_pt_t pt = { ch, render->prop };
 	unsigned int i, right = box.size.width - 1, bottom = box.size.height - 1;
 
+	if(render->func == scr_dlist_output) {
+		scr_dlist_border(render->arg, (struct scr_box_t){ { 0, 0 }, box.size }, pt);
+
+		return;
+	}
+
 	for(i = 0; i < box.size.width; i++) {
 		render_pt(render, (struct scr_coord_t){ i, 0 }, pt);
 		render_pt(render, (struct scr_coord_t){ i, bottom }, pt);
@@ -370,6 +931,56 @@ void scr_view_output(struct scr_coord_t coord, struct scr_pt_t pt, void *arg)
 	scr_view_set(*(struct scr_view_t *)arg, coord, pt);
 }
 
+/**
+ * View span output implementation. The span is clipped once and copied
+ * into the row.
+ *   @coord: The coordinate of the first point.
+ *   @code: The codes.
+ *   @n: The number of points.
+ *   @prop: The property set.
+ *   @arg: The argument.
+ */
+
+_export
+void scr_view_output_span(struct scr_coord_t coord, const uint32_t *code, size_t n, struct scr_prop_t prop, void *arg)
+{
+	size_t i;
+	struct scr_box_t clip;
+	struct scr_pt_t *restrict pt;
+	struct scr_view_t view = *(struct scr_view_t *)arg;
+	int64_t left = coord.x, right = (int64_t)coord.x + n;
+
+	if((coord.y < 0) || (coord.y >= (int64_t)view.box.size.height))
+		return;
+
+	if(left < 0)
+		left = 0;
+
+	if(right > view.box.size.width)
+		right = view.box.size.width;
+
+	if(left >= right)
+		return;
+
+	code += left - coord.x;
+	view.box = (struct scr_box_t){ { view.box.coord.x + left, view.box.coord.y + coord.y }, { right - left, 1 } };
+
+	if(!scr_view_clip(view, &clip))
+		return;
+
+	code += clip.coord.x + view.buf->box.coord.x - view.box.coord.x;
+
+	if(scr_buf_isplane(view.buf)) {
+		memcpy(view.buf->code + scr_clip_index(view.buf, clip, 0), code, clip.size.width * sizeof(uint32_t));
+		scr_plane_attr(view.buf->attr + scr_clip_index(view.buf, clip, 0), clip.size.width, scr_prop_pack(prop));
+	}
+	else {
+		pt = scr_clip_row(view.buf, clip, 0);
+		for(i = 0; i < clip.size.width; i++)
+			pt[i] = (struct scr_pt_t){ code[i], prop };
+	}
+}
+
 /**
  * Accumulator output implementation.
  *   @coord: The coordinate.
@@ -382,3 +993,73 @@ void scr_accum_output(struct scr_coord_t coord, struct scr_pt_t pt, void *arg)
 {
 	scr_accum_set(arg, coord, pt);
 }
+
+/**
+ * Accumulator span output implementation.
+ *   @coord: The coordinate of the first point.
+ *   @code: The codes.
+ *   @n: The number of points.
+ *   @prop: The property set.
+ *   @arg: The argument.
+ */
+
+_export
+void scr_accum_output_span(struct scr_coord_t coord, const uint32_t *code, size_t n, struct scr_prop_t prop, void *arg)
+{
+	scr_accum_span(arg, coord, code, n, prop);
+}
+
+/**
+ * Measuring output implementation, growing a bounding box.
+ *   @coord: The coordinate.
+ *   @pt: The point.
+ *   @arg: The bounding box.
+ */
+
+_export
+void scr_measure_output(struct scr_coord_t coord, struct scr_pt_t pt, void *arg)
+{
+	struct scr_box_t *box = arg;
+	int right, bottom;
+
+	if((box->size.width == 0) || (box->size.height == 0)) {
+		*box = (struct scr_box_t){ coord, { 1, 1 } };
+
+		return;
+	}
+
+	right = box->coord.x + (int)box->size.width;
+	bottom = box->coord.y + (int)box->size.height;
+
+	if(coord.x < box->coord.x)
+		box->coord.x = coord.x;
+	else if(coord.x >= right)
+		right = coord.x + 1;
+
+	if(coord.y < box->coord.y)
+		box->coord.y = coord.y;
+	else if(coord.y >= bottom)
+		bottom = coord.y + 1;
+
+	box->size.width = right - box->coord.x;
+	box->size.height = bottom - box->coord.y;
+}
+
+/**
+ * Measuring span output implementation.
+ *   @coord: The coordinate of the first point.
+ *   @code: The codes.
+ *   @n: The number of points.
+ *   @prop: The property set.
+ *   @arg: The bounding box.
+ */
+
+_export
+void scr_measure_output_span(struct scr_coord_t coord, const uint32_t *code, size_t n, struct scr_prop_t prop, void *arg)
+{
+	if(n == 0)
+		return;
+
+	scr_measure_output(coord, scr_pt_blank, arg);
+	scr_measure_output((struct scr_coord_t){ coord.x + n - 1, coord.y }, scr_pt_blank, arg);
+}
@@ -29,23 +29,54 @@ enum scr_wrap_e {
 
 typedef void (*scr_output_f)(struct scr_coord_t coord, struct scr_pt_t pt, void *arg);
 
+/**
+ * Span output function, receiving a run of points on a single row.
+ *   @coord: The coordinate of the first point.
+ *   @code: The codes.
+ *   @n: The number of points.
+ *   @prop: The property set of every point.
+ *   @arg: The argument.
+ */
+
+typedef void (*scr_span_f)(struct scr_coord_t coord, const uint32_t *code, size_t n, struct scr_prop_t prop, void *arg);
+
+/*
+ * output definitions
+ */
+
+#define SCR_OUTPUT_WORD 32
+
 /**
  * Output structure.
  *   @func: The output function.
+ *   @span: Optional. The span output function.
  *   @arg: The argument.
  *   @coord: The current coordinates.
  *   @prop: The current property set.
  *   @wrap: Text wrapping mode.
+ *   @width: The wrapping width, zero for unlimited.
+ *   @offset: The horizontal scroll offset. Without wrapping, points
+ *     before this column are skipped and the rest are shifted left.
+ *   @limit: The exclusive bottom right limit of the sink. Text past the
+ *     right edge or below the bottom row is skipped without decoding.
+ *   @npend, pend: The pending word of word wrapping, starting at the
+ *     current coordinates.
  */
 
 struct scr_output_t {
 	scr_output_f func;
+	scr_span_f span;
 	void *arg;
 
 	struct scr_coord_t coord;
 	struct scr_prop_t prop;
 
 	enum scr_wrap_e wrap;
+	unsigned int width, offset;
+	struct scr_coord_t limit;
+
+	unsigned int npend;
+	struct scr_pt_t pend[SCR_OUTPUT_WORD];
 };
 
 /**
@@ -74,7 +105,66 @@ struct scr_render_t {
 
 static inline struct scr_output_t scr_output_new(scr_output_f func, void *arg)
 {
-	return (struct scr_output_t){ func, arg, { 0, 0 }, { scr_default_e, scr_default_e, false, false, false }, scr_wrap_none_e };
+	return (struct scr_output_t){
+		.func = func,
+		.arg = arg,
+		.prop = { scr_default_e, scr_default_e, false, false, false },
+		.wrap = scr_wrap_none_e,
+		.limit = { INT_MAX, INT_MAX }
+	};
+}
+
+/**
+ * Create an output that wraps to a given width.
+ *   @func: The function.
+ *   @arg: The argument.
+ *   @wrap: The wrapping mode.
+ *   @width: The wrapping width, zero for unlimited.
+ *   &returns: The output.
+ */
+
+static inline struct scr_output_t scr_output_wrap(scr_output_f func, void *arg, enum scr_wrap_e wrap, unsigned int width)
+{
+	return (struct scr_output_t){
+		.func = func,
+		.arg = arg,
+		.prop = { scr_default_e, scr_default_e, false, false, false },
+		.wrap = wrap,
+		.width = width,
+		.limit = { INT_MAX, INT_MAX }
+	};
+}
+
+/**
+ * Create an output with a span function.
+ *   @func: The function.
+ *   @span: The span function.
+ *   @arg: The argument.
+ *   &returns: The output.
+ */
+
+static inline struct scr_output_t scr_output_span(scr_output_f func, scr_span_f span, void *arg)
+{
+	return (struct scr_output_t){
+		.func = func,
+		.span = span,
+		.arg = arg,
+		.prop = { scr_default_e, scr_default_e, false, false, false },
+		.wrap = scr_wrap_none_e,
+		.limit = { INT_MAX, INT_MAX }
+	};
+}
+
+/**
+ * Determine if an output is exhausted, with all further text falling below
+ * the bottom row of the sink.
+ *   @output: The output.
+ *   &returns: True if exhausted.
+ */
+
+static inline bool scr_output_done(const struct scr_output_t *output)
+{
+	return output->coord.y >= output->limit.y;
 }
 
 /**
@@ -108,6 +198,8 @@ static inline struct scr_render_t scr_render_new(scr_output_f func, void *arg, s
  */
 
 void scr_output_write(struct scr_output_t *output, const void *restrict buf, size_t nbytes);
+void scr_output_flush(struct scr_output_t *output);
+struct io_output_t scr_output_io(struct scr_output_t *output);
 
 void scr_printf(struct scr_output_t *output, const char *restrict format, ...);
 void scr_vprintf(struct scr_output_t *output, const char *restrict format, va_list args);
@@ -117,12 +209,20 @@ struct io_chunk_t scr_chunk_neg(bool value);
 struct io_chunk_t scr_chunk_uline(bool value);
 struct io_chunk_t scr_chunk_error(bool value);
 
+unsigned int scr_chunk_skip(struct io_output_t output);
+void scr_chunk_seek(struct io_output_t output, unsigned int ncols);
+
+struct scr_box_t scr_measure(struct io_chunk_t chunk, unsigned int width);
+struct scr_buf_t *scr_chunk_buf(struct io_chunk_t chunk, unsigned int width);
+void scr_view_print(struct scr_view_t view, struct io_chunk_t chunk);
+
 /*
  * view function declarations
  */
 
 void scr_view_fill(struct scr_view_t view, struct scr_pt_t pt);
 void scr_view_fill_code(struct scr_view_t view, uint32_t code);
+void scr_view_fill_prop(struct scr_view_t view, struct scr_prop_t prop);
 
 /*
  * render function declarations
@@ -137,19 +237,40 @@ void scr_render_border(struct scr_render_t *render, char ch);
  */
 
 void scr_view_output(struct scr_coord_t coord, struct scr_pt_t pt, void *arg);
+void scr_view_output_span(struct scr_coord_t coord, const uint32_t *code, size_t n, struct scr_prop_t prop, void *arg);
 void scr_accum_output(struct scr_coord_t coord, struct scr_pt_t pt, void *arg);
+void scr_accum_output_span(struct scr_coord_t coord, const uint32_t *code, size_t n, struct scr_prop_t prop, void *arg);
+void scr_measure_output(struct scr_coord_t coord, struct scr_pt_t pt, void *arg);
+void scr_measure_output_span(struct scr_coord_t coord, const uint32_t *code, size_t n, struct scr_prop_t prop, void *arg);
 
 /*
  * output implementation macros
  */
 
-#define scr_output_view(view) scr_output_new(scr_view_output, &(union { struct scr_view_t v; }){ .v = view }.v)
-#define scr_output_accum(accum) scr_output_new(scr_accum_output, (union { struct scr_accum_t *v; }){ .v = accum }.v)
+#define scr_output_view(view) _scr_output_view(&(union { struct scr_view_t v; }){ .v = view }.v)
+#define scr_output_accum(accum) scr_output_span(scr_accum_output, scr_accum_output_span, (union { struct scr_accum_t *v; }){ .v = accum }.v)
+#define scr_output_measure(box) scr_output_span(scr_measure_output, scr_measure_output_span, (union { struct scr_box_t *v; }){ .v = box }.v)
 
 #define scr_render_view(view) _scr_render_view(&(union { struct scr_view_t v; }){ .v = view }.v)
 #define scr_render_accum(accum, box) scr_render_new(scr_accum_output, (union { struct scr_accum_t *v; }){ .v = accum }.v, box)
 
 
+/**
+ * View reference output helper. The wrapping width is the view width.
+ *   @view: The view.
+ *   &returns: The output.
+ */
+
+static inline struct scr_output_t _scr_output_view(struct scr_view_t *view)
+{
+	struct scr_output_t output = scr_output_span(scr_view_output, scr_view_output_span, view);
+
+	output.width = view->box.size.width;
+	output.limit = (struct scr_coord_t){ view->box.size.width, view->box.size.height };
+
+	return output;
+}
+
 /**
  * View reference renderer helper.
  *   @view: The view.
@@ -167,4 +288,11 @@ static inline struct scr_render_t _scr_render_view(struct scr_view_t *view)
  * end header: scr.h
  */
 
+
+/*
+ * internal output function declarations
+ */
+
+struct scr_buf_t *scr_buf_wrap(struct scr_buf_t *src, unsigned int width);
+
 #endif
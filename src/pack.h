@@ -51,11 +51,17 @@ static inline struct scr_view_t scr_pack_pad(struct scr_view_t view, unsigned in
 {
 	struct scr_view_t pack;
 
+	if(2 * horiz > view.box.size.width)
+		horiz = view.box.size.width / 2;
+
+	if(2 * vert > view.box.size.height)
+		vert = view.box.size.height / 2;
+
 	pack.buf = view.buf;
 	pack.box.coord.x = view.box.coord.x + horiz;
 	pack.box.coord.y = view.box.coord.y + vert;
-	pack.box.size.width -= 2 * horiz;
-	pack.box.size.height -= 2 * vert;
+	pack.box.size.width = view.box.size.width - 2 * horiz;
+	pack.box.size.height = view.box.size.height - 2 * vert;
 
 	return pack;
 }
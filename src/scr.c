@@ -1,15 +1,27 @@
 #include "common.h"
 #include "buf.h"
 #include "iface.h"
+#include "lat.h"
+#include "scr.h"
+#include "snap.h"
 
 
 /**
  * Screen structure.
  *   @impl: The implementation.
+ *   @spare: The spare frame buffer.
+ *   @rec: The session recording.
+ *   @stamp, parse, render: The pending event receive, parse, and render times.
+ *   @lat: The latency histograms.
  */
 
 struct scr_t {
 	struct scr_impl_t *impl;
+	struct scr_buf_t *spare;
+	struct scr_snap_t *rec;
+
+	uint64_t stamp, parse, render;
+	struct scr_hist_t lat[scr_lat_n];
 };
 
 
@@ -22,11 +34,39 @@ struct scr_t {
 
 _export
 struct scr_t *scr_open(struct io_input_t input, struct io_output_t output)
+{
+	return scr_new(scr_impl_open(input, output));
+}
+
+/**
+ * Open a screen on an input and output file descriptor. The descriptors may
+ * be ttys, pty masters, or sockets; they are not closed with the screen.
+ *   @input: The input file descriptor.
+ *   @output: The output file descriptor.
+ *   &returns: The screen.
+ */
+
+_export
+struct scr_t *scr_openfd(int input, int output)
+{
+	return scr_new(scr_impl_openfd(input, output));
+}
+
+/**
+ * Create a screen on an implementation.
+ *   @impl: The implementation.
+ *   &returns: The screen.
+ */
+
+struct scr_t *scr_new(struct scr_impl_t *impl)
 {
 	struct scr_t *scr;
 
 	scr = mem_alloc(sizeof(struct scr_t));
-	scr->impl = scr_impl_open(input, output);
+	scr->impl = impl;
+	scr->spare = NULL;
+	scr->rec = NULL;
+	scr_latency_reset(scr);
 
 	return scr;
 }
@@ -39,7 +79,9 @@ struct scr_t *scr_open(struct io_input_t input, struct io_output_t output)
 _export
 void scr_close(struct scr_t *scr)
 {
+	scr_record_stop(scr);
 	scr_impl_close(scr->impl);
+	scr_buf_delete(scr->spare);
 	mem_free(scr);
 }
 
@@ -54,7 +96,26 @@ void scr_close(struct scr_t *scr)
 _export
 int32_t scr_read(struct scr_t *scr, int timeout)
 {
-	return scr_impl_read(scr->impl, timeout);
+	int32_t key;
+	uint64_t stamp, now;
+
+	key = scr_impl_read(scr->impl, timeout);
+	if(key == 0)
+		return key;
+
+	now = scr_lat_now();
+	stamp = scr_impl_stamp(scr->impl);
+	scr_hist_add(&scr->lat[scr_lat_input_e], now - stamp);
+
+	if(scr->rec != NULL)
+		scr_snap_input(scr->rec, key);
+
+	if(scr->stamp == 0) {
+		scr->stamp = stamp;
+		scr->parse = now;
+	}
+
+	return key;
 }
 
 /**
@@ -70,14 +131,58 @@ struct scr_size_t scr_size(struct scr_t *scr)
 }
 
 /**
- * Generate a blank buffer for the screen.
+ * Retrieve the output statistics of the screen.
+ *   @scr: The screen.
+ *   &returns: The statistics.
+ */
+
+_export
+struct scr_stat_t scr_stat(struct scr_t *scr)
+{
+	return scr_impl_stat(scr->impl);
+}
+
+/**
+ * Check if the output of the screen has failed, either from a write error or
+ * from a peer that stopped reading. Later frames are discarded.
+ *   @scr: The screen.
+ *   &returns: True if the output failed.
+ */
+
+_export
+bool scr_failed(struct scr_t *scr)
+{
+	return scr_impl_failed(scr->impl);
+}
+
+/**
+ * Generate a blank lazy buffer for the screen. The buffer displaced by the
+ * last swap is recycled and cleared in constant time when the size has not
+ * changed.
  *   @scr: The screen.
  */
 
 _export
 struct scr_buf_t *scr_buf(struct scr_t *scr)
 {
-	return scr_buf_new((struct scr_box_t){ { 0, 0 }, scr_size(scr) });
+	struct scr_buf_t *buf;
+	struct scr_size_t size;
+
+	scr_latency_mark(scr);
+
+	size = scr_size(scr);
+	buf = scr->spare;
+	scr->spare = NULL;
+
+	if((buf != NULL) && (buf->box.size.width == size.width) && (buf->box.size.height == size.height)) {
+		scr_buf_clear(buf);
+
+		return buf;
+	}
+
+	scr_buf_delete(buf);
+
+	return scr_buf_lazy((struct scr_box_t){ { 0, 0 }, size });
 }
 
 /**
@@ -89,5 +194,111 @@ struct scr_buf_t *scr_buf(struct scr_t *scr)
 _export
 void scr_swap(struct scr_t *scr, struct scr_buf_t *buf)
 {
-	scr_impl_swap(scr->impl, buf);
+	uint64_t start, end;
+
+	scr_buf_delete(scr->spare);
+
+	if(scr->rec != NULL)
+		scr_snap_write(scr->rec, buf);
+
+	start = scr_lat_now();
+	scr->spare = scr_impl_swap(scr->impl, buf);
+	end = scr_lat_now();
+
+	if(scr->stamp == 0)
+		return;
+
+	if(scr->render == 0)
+		scr->render = start;
+
+	scr_hist_add(&scr->lat[scr_lat_logic_e], scr->render - scr->parse);
+	scr_hist_add(&scr->lat[scr_lat_render_e], start - scr->render);
+	scr_hist_add(&scr->lat[scr_lat_write_e], end - start);
+	scr_hist_add(&scr->lat[scr_lat_total_e], end - scr->stamp);
+
+	scr->stamp = scr->parse = scr->render = 0;
+}
+
+
+/**
+ * Start recording every swapped frame and every input event of the screen,
+ * replacing any current recording. Frames are stored as deltas.
+ *   @scr: The screen.
+ *   @path: The recording path.
+ *   &returns: True if recording, false if the file could not be opened.
+ */
+
+_export
+bool scr_record(struct scr_t *scr, const char *path)
+{
+	scr_record_stop(scr);
+	scr->rec = scr_snap_open(path);
+
+	return scr->rec != NULL;
+}
+
+/**
+ * Stop recording the screen, if recording. A write that fails during the
+ * recording stops further writes and is reported here.
+ *   @scr: The screen.
+ *   &returns: True if the recording was written completely or there was no
+ *     recording, false if the file is incomplete.
+ */
+
+_export
+bool scr_record_stop(struct scr_t *scr)
+{
+	bool done;
+
+	if(scr->rec == NULL)
+		return true;
+
+	done = scr_snap_close(scr->rec);
+	scr->rec = NULL;
+
+	return done;
+}
+
+
+/**
+ * Mark the start of rendering for the pending event. Called implicitly by
+ * 'scr_buf', only needed when rendering into a buffer from elsewhere.
+ *   @scr: The screen.
+ */
+
+_export
+void scr_latency_mark(struct scr_t *scr)
+{
+	if((scr->stamp != 0) && (scr->render == 0))
+		scr->render = scr_lat_now();
+}
+
+/**
+ * Retrieve the latency summary for a stage. Every stage except input is
+ * measured from the oldest event that was read before a swap.
+ *   @scr: The screen.
+ *   @stage: The stage.
+ *   &returns: The latency summary.
+ */
+
+_export
+struct scr_lat_t scr_latency(struct scr_t *scr, enum scr_lat_e stage)
+{
+	return scr_hist_sum(&scr->lat[stage]);
+}
+
+/**
+ * Reset all latency histograms.
+ *   @scr: The screen.
+ */
+
+_export
+void scr_latency_reset(struct scr_t *scr)
+{
+	unsigned int i;
+
+	scr->stamp = scr->parse = scr->render = 0;
+
+	for(i = 0; i < scr_lat_n; i++)
+		scr_hist_init(&scr->lat[i]);
 }
@@ -13,22 +13,51 @@
 
 struct scr_t;
 
+/**
+ * Output statistics structure.
+ *   @bytes: The number of bytes written.
+ *   @writes: The number of write calls.
+ */
+
+struct scr_stat_t {
+	uint64_t bytes, writes;
+};
+
 /*
  * screen function declarations
  */
 
 struct scr_t *scr_open(struct io_input_t input, struct io_output_t output);
+struct scr_t *scr_openfd(int input, int output);
 void scr_close(struct scr_t *scr);
 
 int32_t scr_read(struct scr_t *scr, int timeout);
 struct scr_size_t scr_size(struct scr_t *scr);
+struct scr_stat_t scr_stat(struct scr_t *scr);
+bool scr_failed(struct scr_t *scr);
 struct scr_buf_t *scr_buf(struct scr_t *scr);
 void scr_swap(struct scr_t *scr, struct scr_buf_t *buf);
 
+bool scr_record(struct scr_t *scr, const char *path);
+bool scr_record_stop(struct scr_t *scr);
+
+void scr_latency_mark(struct scr_t *scr);
+struct scr_lat_t scr_latency(struct scr_t *scr, enum scr_lat_e stage);
+void scr_latency_reset(struct scr_t *scr);
+
 /* %~scr.h% */
 
 /*
  * end header: scr.h
  */
 
+
+/*
+ * internal screen function declarations
+ */
+
+struct scr_impl_t;
+
+struct scr_t *scr_new(struct scr_impl_t *impl);
+
 #endif
@@ -0,0 +1,74 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+/*
+ * start header: scr.h
+ */
+
+/* %scr.h% */
+
+/*
+ * structure prototypes
+ */
+
+struct scr_t;
+struct scr_server_t;
+struct scr_session_t;
+
+
+/**
+ * Session key press function.
+ *   @ref: The reference.
+ *   @key: The key.
+ *   &returns: True to keep the session open, false to close it.
+ */
+
+typedef bool (*scr_session_key_f)(void *ref, int32_t key);
+
+/**
+ * Session render function.
+ *   @ref: The reference.
+ *   @view: The target view.
+ */
+
+typedef void (*scr_session_render_f)(void *ref, struct scr_view_t view);
+
+/**
+ * Session interface.
+ *   @keypress: Key press.
+ *   @render: Render.
+ *   @delete: Delete.
+ */
+
+struct scr_session_i {
+	scr_session_key_f keypress;
+	scr_session_render_f render;
+	delete_f delete;
+};
+
+
+/*
+ * server function declarations
+ */
+
+struct scr_server_t *scr_server_new(unsigned int nworkers);
+void scr_server_delete(struct scr_server_t *server);
+
+void scr_server_run(struct scr_server_t *server);
+void scr_server_stop(struct scr_server_t *server);
+
+struct scr_session_t *scr_server_add(struct scr_server_t *server, int input, int output, void *ref, const struct scr_session_i *iface);
+
+/*
+ * session function declarations
+ */
+
+struct scr_t *scr_session_scr(struct scr_session_t *session);
+
+/* %~scr.h% */
+
+/*
+ * end header: scr.h
+ */
+
+#endif
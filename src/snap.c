@@ -0,0 +1,730 @@
+#include "common.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "buf.h"
+#include "lat.h"
+#include "scr.h"
+#include "snap.h"
+
+
+/*
+ * snapshot definitions
+ */
+
+#define SNAP_MAGIC    0x53524353
+#define SNAP_VERSION  1
+#define SNAP_KEY      240
+#define SNAP_GAP      4
+
+/**
+ * Record kind enumerator.
+ *   @snap_key_e: Key frame.
+ *   @snap_delta_e: Delta frame.
+ *   @snap_input_e: Input event.
+ */
+
+enum snap_e {
+	snap_key_e = 1,
+	snap_delta_e = 2,
+	snap_input_e = 3
+};
+
+/**
+ * File header structure.
+ *   @magic, version: The magic number and version.
+ */
+
+struct snap_head_t {
+	uint32_t magic, version;
+};
+
+/**
+ * Record header structure. Every record is padded to eight bytes so that
+ * the planes of a mapped file are aligned.
+ *   @kind: The record kind.
+ *   @size: The padded payload size.
+ *   @time: The time since the start of the capture.
+ */
+
+struct snap_rec_t {
+	uint32_t kind, size;
+	uint64_t time;
+};
+
+/**
+ * Frame header structure. A key frame is followed by the code and attribute
+ * planes, a delta frame by the runs and then the codes and attributes of
+ * the points within the runs.
+ *   @x, y: The box coordinate.
+ *   @width, height: The box size.
+ *   @nruns: The number of runs.
+ *   @npts: The number of points stored.
+ */
+
+struct snap_frame_t {
+	int32_t x, y;
+	uint32_t width, height;
+	uint32_t nruns, npts;
+};
+
+/**
+ * Input record structure.
+ *   @key: The key.
+ *   @pad: Padding.
+ */
+
+struct snap_input_t {
+	int32_t key;
+	uint32_t pad;
+};
+
+/**
+ * Snapshot writer structure.
+ *   @file: The file.
+ *   @fail: The failed write flag, set once any write falls short.
+ *   @start: The start time.
+ *   @nframes: The number of frames since the last key frame.
+ *   @box: The box of the last frame.
+ *   @code, attr: The current and previous code and attribute planes.
+ *   @run: The run array.
+ */
+
+struct scr_snap_t {
+	FILE *file;
+	bool fail;
+	uint64_t start;
+	unsigned int nframes;
+
+	struct scr_box_t box;
+	uint32_t *code[2];
+	uint16_t *attr[2];
+	uint32_t *run;
+};
+
+/**
+ * Replay structure.
+ *   @base, len: The mapped file and its length.
+ *   @off: The offset of the next record.
+ */
+
+struct scr_replay_t {
+	const uint8_t *base;
+	size_t len, off;
+};
+
+
+/*
+ * local function declarations
+ */
+
+static void snap_load(struct scr_snap_t *snap, struct scr_buf_t *buf, size_t npts);
+static uint32_t snap_diff(struct scr_snap_t *snap, size_t npts, uint32_t *nchanged);
+static void snap_rec(struct scr_snap_t *snap, enum snap_e kind, size_t size, uint64_t time);
+static void snap_pad(struct scr_snap_t *snap, size_t size);
+static void snap_out(struct scr_snap_t *snap, const void *ptr, size_t size, size_t n);
+
+static bool snap_runs(const uint32_t *run, uint32_t nruns, size_t npts, size_t nchanged);
+static void frame_span(struct scr_buf_t *buf, size_t idx, const uint32_t *code, const uint16_t *attr, size_t n);
+
+/*
+ * local variables
+ */
+
+static const uint8_t snap_zero[8] = { 0 };
+
+
+/**
+ * Compute a size padded to eight bytes.
+ *   @size: The size.
+ *   &returns: The padded size.
+ */
+
+static inline size_t snap_align(size_t size)
+{
+	return (size + 7) & ~(size_t)7;
+}
+
+
+/**
+ * Open a snapshot file for writing.
+ *   @path: The path.
+ *   &returns: The snapshot writer, or null on failure.
+ */
+
+_export
+struct scr_snap_t *scr_snap_open(const char *path)
+{
+	FILE *file;
+	struct scr_snap_t *snap;
+	struct snap_head_t head = { SNAP_MAGIC, SNAP_VERSION };
+
+	file = fopen(path, "wb");
+	if(file == NULL)
+		return NULL;
+
+	if(fwrite(&head, sizeof(head), 1, file) != 1) {
+		fclose(file);
+
+		return NULL;
+	}
+
+	snap = mem_alloc(sizeof(struct scr_snap_t));
+	snap->file = file;
+	snap->fail = false;
+	snap->start = scr_lat_now();
+	snap->nframes = 0;
+	snap->box = (struct scr_box_t){ { 0, 0 }, { 0, 0 } };
+	snap->code[0] = snap->code[1] = NULL;
+	snap->attr[0] = snap->attr[1] = NULL;
+	snap->run = NULL;
+
+	return snap;
+}
+
+/**
+ * Close a snapshot writer, flushing the file.
+ *   @snap: The snapshot writer.
+ *   &returns: True if every record was written, false if the file is
+ *     incomplete.
+ */
+
+_export
+bool scr_snap_close(struct scr_snap_t *snap)
+{
+	bool fail = snap->fail;
+
+	if(fclose(snap->file) != 0)
+		fail = true;
+
+	mem_delete(snap->code[0]);
+	mem_delete(snap->code[1]);
+	mem_delete(snap->attr[0]);
+	mem_delete(snap->attr[1]);
+	mem_delete(snap->run);
+	mem_free(snap);
+
+	return !fail;
+}
+
+
+/**
+ * Write a frame to the snapshot. Frames are written as deltas against the
+ * previous frame, with a key frame whenever the box changes, a delta would
+ * be larger, or after 'SNAP_KEY' frames. Once a write has failed, nothing
+ * more is written.
+ *   @snap: The snapshot writer.
+ *   @buf: The buffer.
+ *   &returns: True if written, false if this or an earlier write failed.
+ */
+
+_export
+bool scr_snap_write(struct scr_snap_t *snap, struct scr_buf_t *buf)
+{
+	uint32_t i, nruns = 0, nchanged = 0;
+	size_t size;
+	uint64_t time = scr_lat_now() - snap->start;
+	size_t npts = (size_t)buf->box.size.width * buf->box.size.height;
+	bool key = snap->nframes >= SNAP_KEY;
+	struct snap_frame_t frame;
+
+	if(snap->fail)
+		return false;
+
+	if(memcmp(&snap->box, &buf->box, sizeof(struct scr_box_t)) != 0) {
+		snap->box = buf->box;
+		snap->code[0] = mem_realloc(snap->code[0], npts * sizeof(uint32_t));
+		snap->code[1] = mem_realloc(snap->code[1], npts * sizeof(uint32_t));
+		snap->attr[0] = mem_realloc(snap->attr[0], npts * sizeof(uint16_t));
+		snap->attr[1] = mem_realloc(snap->attr[1], npts * sizeof(uint16_t));
+		snap->run = mem_realloc(snap->run, (npts + 2) * sizeof(uint32_t));
+		key = true;
+	}
+
+	snap_load(snap, buf, npts);
+
+	if(!key) {
+		nruns = snap_diff(snap, npts, &nchanged);
+		key = (2 * nruns * sizeof(uint32_t) + nchanged * (sizeof(uint32_t) + sizeof(uint16_t))) >= npts * (sizeof(uint32_t) + sizeof(uint16_t));
+	}
+
+	frame = (struct snap_frame_t){ buf->box.coord.x, buf->box.coord.y, buf->box.size.width, buf->box.size.height, 0, npts };
+
+	if(key) {
+		size = sizeof(frame) + npts * (sizeof(uint32_t) + sizeof(uint16_t));
+		snap_rec(snap, snap_key_e, size, time);
+		snap_out(snap, &frame, sizeof(frame), 1);
+		snap_out(snap, snap->code[0], sizeof(uint32_t), npts);
+		snap_out(snap, snap->attr[0], sizeof(uint16_t), npts);
+		snap_pad(snap, size);
+		snap->nframes = 0;
+	}
+	else {
+		frame.nruns = nruns;
+		frame.npts = nchanged;
+
+		size = sizeof(frame) + 2 * nruns * sizeof(uint32_t) + nchanged * (sizeof(uint32_t) + sizeof(uint16_t));
+		snap_rec(snap, snap_delta_e, size, time);
+		snap_out(snap, &frame, sizeof(frame), 1);
+		snap_out(snap, snap->run, sizeof(uint32_t), 2 * nruns);
+
+		for(i = 0; i < nruns; i++)
+			snap_out(snap, snap->code[0] + snap->run[2 * i], sizeof(uint32_t), snap->run[2 * i + 1]);
+
+		for(i = 0; i < nruns; i++)
+			snap_out(snap, snap->attr[0] + snap->run[2 * i], sizeof(uint16_t), snap->run[2 * i + 1]);
+
+		snap_pad(snap, size);
+		snap->nframes++;
+	}
+
+	return !snap->fail;
+}
+
+/**
+ * Write an input event to the snapshot.
+ *   @snap: The snapshot writer.
+ *   @key: The key.
+ *   &returns: True if written, false if this or an earlier write failed.
+ */
+
+_export
+bool scr_snap_input(struct scr_snap_t *snap, int32_t key)
+{
+	struct snap_input_t input = { key, 0 };
+
+	if(snap->fail)
+		return false;
+
+	snap_rec(snap, snap_input_e, sizeof(input), scr_lat_now() - snap->start);
+	snap_out(snap, &input, sizeof(input), 1);
+
+	return !snap->fail;
+}
+
+/**
+ * Load a buffer into the current planes of the snapshot, making the
+ * previous current planes the reference.
+ *   @snap: The snapshot writer.
+ *   @buf: The buffer.
+ *   @npts: The number of points.
+ */
+
+static void snap_load(struct scr_snap_t *snap, struct scr_buf_t *buf, size_t npts)
+{
+	uint32_t *code;
+	uint16_t *attr;
+	unsigned int x, y, width = buf->box.size.width;
+	const struct scr_pt_t *pt;
+
+	code = snap->code[1], snap->code[1] = snap->code[0], snap->code[0] = code;
+	attr = snap->attr[1], snap->attr[1] = snap->attr[0], snap->attr[0] = attr;
+
+	if(scr_buf_isplane(buf)) {
+		memcpy(code, buf->code, npts * sizeof(uint32_t));
+		memcpy(attr, buf->attr, npts * sizeof(uint16_t));
+
+		return;
+	}
+
+	for(y = 0; y < buf->box.size.height; y++, code += width, attr += width) {
+		if(!scr_buf_live(buf, y)) {
+			scr_plane_code(code, width, scr_pt_blank.code);
+			scr_plane_attr(attr, width, scr_prop_pack(scr_pt_blank.prop));
+			continue;
+		}
+
+		pt = buf->pt + (size_t)y * width;
+		for(x = 0; x < width; x++) {
+			code[x] = pt[x].code;
+			attr[x] = scr_prop_pack(pt[x].prop);
+		}
+	}
+}
+
+/**
+ * Compute the runs of changed points between the current and previous
+ * planes. Runs separated by fewer than 'SNAP_GAP' unchanged points are
+ * merged.
+ *   @snap: The snapshot writer.
+ *   @npts: The number of points.
+ *   @nchanged: Out. The number of points within the runs.
+ *   &returns: The number of runs.
+ */
+
+static uint32_t snap_diff(struct scr_snap_t *snap, size_t npts, uint32_t *nchanged)
+{
+	size_t i, j, end;
+	uint32_t nruns = 0;
+	const uint32_t *cur = snap->code[0], *prev = snap->code[1];
+	const uint16_t *acur = snap->attr[0], *aprev = snap->attr[1];
+
+	*nchanged = 0;
+
+	for(i = 0; i < npts; i++) {
+		if((cur[i] == prev[i]) && (acur[i] == aprev[i]))
+			continue;
+
+		for(end = j = i + 1; (j < npts) && ((j - end) < SNAP_GAP); j++) {
+			if((cur[j] != prev[j]) || (acur[j] != aprev[j]))
+				end = j + 1;
+		}
+
+		snap->run[2 * nruns] = i;
+		snap->run[2 * nruns + 1] = end - i;
+		*nchanged += end - i;
+		nruns++;
+		i = end;
+	}
+
+	return nruns;
+}
+
+/**
+ * Write a record header.
+ *   @snap: The snapshot writer.
+ *   @kind: The kind.
+ *   @size: The unpadded payload size.
+ *   @time: The time.
+ */
+
+static void snap_rec(struct scr_snap_t *snap, enum snap_e kind, size_t size, uint64_t time)
+{
+	struct snap_rec_t rec = { kind, snap_align(size), time };
+
+	snap_out(snap, &rec, sizeof(rec), 1);
+}
+
+/**
+ * Pad a record to eight bytes.
+ *   @snap: The snapshot writer.
+ *   @size: The unpadded payload size.
+ */
+
+static void snap_pad(struct scr_snap_t *snap, size_t size)
+{
+	snap_out(snap, snap_zero, 1, snap_align(size) - size);
+}
+
+/**
+ * Write data to the snapshot file, setting the failed flag on a short
+ * write.
+ *   @snap: The snapshot writer.
+ *   @ptr: The data.
+ *   @size: The size of an element.
+ *   @n: The number of elements.
+ */
+
+static void snap_out(struct scr_snap_t *snap, const void *ptr, size_t size, size_t n)
+{
+	if((n > 0) && (fwrite(ptr, size, n, snap->file) != n))
+		snap->fail = true;
+}
+
+
+/**
+ * Open a snapshot file for replay. The file is mapped and never copied.
+ *   @path: The path.
+ *   &returns: The replay, or null on failure.
+ */
+
+_export
+struct scr_replay_t *scr_replay_open(const char *path)
+{
+	int fd;
+	void *base;
+	struct stat st;
+	struct scr_replay_t *replay;
+	const struct snap_head_t *head;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(fd < 0)
+		return NULL;
+
+	if((fstat(fd, &st) < 0) || (st.st_size < (off_t)sizeof(struct snap_head_t))) {
+		close(fd);
+
+		return NULL;
+	}
+
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if(base == MAP_FAILED)
+		return NULL;
+
+	head = base;
+	if((head->magic != SNAP_MAGIC) || (head->version != SNAP_VERSION)) {
+		munmap(base, st.st_size);
+
+		return NULL;
+	}
+
+	replay = mem_alloc(sizeof(struct scr_replay_t));
+	replay->base = base;
+	replay->len = st.st_size;
+	replay->off = sizeof(struct snap_head_t);
+
+	return replay;
+}
+
+/**
+ * Close a replay.
+ *   @replay: The replay.
+ */
+
+_export
+void scr_replay_close(struct scr_replay_t *replay)
+{
+	munmap((void *)replay->base, replay->len);
+	mem_free(replay);
+}
+
+
+/**
+ * Step to the next record of a replay.
+ *   @replay: The replay.
+ *   @frame: Out. The frame, if a frame was read.
+ *   @input: Out. The input event, if an input event was read.
+ *   &returns: The record kind, or end at the end or on a truncated or
+ *     corrupt record.
+ */
+
+_export
+enum scr_rec_e scr_replay_step(struct scr_replay_t *replay, struct scr_frame_t *frame, struct scr_input_t *input)
+{
+	size_t npts, need;
+	const struct snap_rec_t *rec;
+	const struct snap_frame_t *head;
+
+	while((replay->off + sizeof(struct snap_rec_t)) <= replay->len) {
+		rec = (const void *)(replay->base + replay->off);
+		if((replay->len - replay->off - sizeof(struct snap_rec_t)) < rec->size)
+			return scr_rec_end_e;
+
+		replay->off += sizeof(struct snap_rec_t) + rec->size;
+
+		if(rec->kind == snap_input_e) {
+			if(rec->size < sizeof(struct snap_input_t))
+				return scr_rec_end_e;
+
+			input->time = rec->time;
+			input->key = ((const struct snap_input_t *)(rec + 1))->key;
+
+			return scr_rec_input_e;
+		}
+		else if((rec->kind != snap_key_e) && (rec->kind != snap_delta_e))
+			continue;
+
+		head = (const void *)(rec + 1);
+		if(rec->size < sizeof(struct snap_frame_t))
+			return scr_rec_end_e;
+
+		npts = (size_t)head->width * head->height;
+		need = sizeof(struct snap_frame_t) + 2 * (size_t)head->nruns * sizeof(uint32_t) + (size_t)head->npts * (sizeof(uint32_t) + sizeof(uint16_t));
+		if((need > rec->size) || (head->npts > npts) || ((rec->kind == snap_key_e) && (head->npts != npts)))
+			return scr_rec_end_e;
+
+		if((rec->kind == snap_delta_e) && !snap_runs((const uint32_t *)(head + 1), head->nruns, npts, head->npts))
+			return scr_rec_end_e;
+
+		frame->key = (rec->kind == snap_key_e);
+		frame->time = rec->time;
+		frame->box = (struct scr_box_t){ { head->x, head->y }, { head->width, head->height } };
+		frame->nruns = head->nruns;
+		frame->run = (const uint32_t *)(head + 1);
+		frame->code = frame->run + 2 * head->nruns;
+		frame->attr = (const uint16_t *)(frame->code + head->npts);
+
+		return scr_rec_frame_e;
+	}
+
+	return scr_rec_end_e;
+}
+
+/**
+ * Retrieve the next frame of a replay. Records of other kinds are skipped.
+ *   @replay: The replay.
+ *   @frame: Out. The frame.
+ *   &returns: True if a frame was read, false at the end or on a truncated
+ *     record.
+ */
+
+_export
+bool scr_replay_next(struct scr_replay_t *replay, struct scr_frame_t *frame)
+{
+	enum scr_rec_e kind;
+	struct scr_input_t input;
+
+	while((kind = scr_replay_step(replay, frame, &input)) == scr_rec_input_e);
+
+	return kind == scr_rec_frame_e;
+}
+
+/**
+ * Rewind a replay to the first frame.
+ *   @replay: The replay.
+ */
+
+_export
+void scr_replay_rewind(struct scr_replay_t *replay)
+{
+	replay->off = sizeof(struct snap_head_t);
+}
+
+
+/**
+ * Apply a frame to a buffer. The buffer size must match the frame, and for
+ * a delta frame the buffer must hold the previous frame.
+ *   @frame: The frame.
+ *   @buf: The buffer.
+ */
+
+_export
+void scr_frame_apply(const struct scr_frame_t *frame, struct scr_buf_t *buf)
+{
+	uint32_t i;
+	size_t off = 0;
+
+	if((buf->box.size.width != frame->box.size.width) || (buf->box.size.height != frame->box.size.height))
+		_fatal("Frame size does not match the buffer.");
+
+	if(frame->key) {
+		frame_span(buf, 0, frame->code, frame->attr, (size_t)frame->box.size.width * frame->box.size.height);
+
+		return;
+	}
+
+	for(i = 0; i < frame->nruns; i++) {
+		frame_span(buf, frame->run[2 * i], frame->code + off, frame->attr + off, frame->run[2 * i + 1]);
+		off += frame->run[2 * i + 1];
+	}
+}
+
+/**
+ * Play a recorded session on a screen. Frames are placed at their recorded
+ * box and clipped to the screen size. Playback is visual only: recorded
+ * input events are skipped, not replayed, and 'scr_replay_step' gives
+ * access to them. In realtime mode, playback waits for each frame's
+ * original time and stops early on a key press on the screen.
+ *   @scr: The screen.
+ *   @path: The recording path.
+ *   @realtime: Flag to play at the original speed, otherwise as fast as
+ *     possible.
+ *   &returns: True if the recording was played, false if it failed to open.
+ */
+
+_export
+bool scr_play(struct scr_t *scr, const char *path, bool realtime)
+{
+	int wait;
+	enum scr_rec_e kind;
+	uint64_t start, now;
+	struct scr_frame_t frame;
+	struct scr_input_t input;
+	struct scr_replay_t *replay;
+	struct scr_buf_t *cur = NULL, *buf;
+
+	replay = scr_replay_open(path);
+	if(replay == NULL)
+		return false;
+
+	start = scr_lat_now();
+
+	while((kind = scr_replay_step(replay, &frame, &input)) != scr_rec_end_e) {
+		if(kind != scr_rec_frame_e)
+			continue;
+
+		if(frame.key && ((cur == NULL) || (memcmp(&cur->box, &frame.box, sizeof(struct scr_box_t)) != 0)))
+			scr_buf_replace(&cur, scr_buf_soa(frame.box));
+
+		if(cur == NULL)
+			continue;
+
+		scr_frame_apply(&frame, cur);
+
+		if(realtime) {
+			now = scr_lat_now() - start;
+			wait = (frame.time > now) ? (frame.time - now + 999999) / 1000000 : 0;
+
+			if(scr_read(scr, wait) != 0)
+				break;
+		}
+
+		buf = scr_buf(scr);
+		scr_blit(scr_view_new(buf), cur);
+		scr_swap(scr, buf);
+	}
+
+	scr_buf_delete(cur);
+	scr_replay_close(replay);
+
+	return true;
+}
+
+
+/**
+ * Validate the runs of a delta frame. Runs must be ascending, must not
+ * overlap, must lie within the frame, and must cover exactly the stored
+ * points.
+ *   @run: The offset and length pairs.
+ *   @nruns: The number of runs.
+ *   @npts: The number of points of the frame.
+ *   @nchanged: The number of points stored.
+ *   &returns: True if valid, false otherwise.
+ */
+
+static bool snap_runs(const uint32_t *run, uint32_t nruns, size_t npts, size_t nchanged)
+{
+	uint32_t i;
+	size_t end = 0, total = 0;
+
+	for(i = 0; i < nruns; i++) {
+		if((run[2 * i] < end) || (run[2 * i] > npts) || (run[2 * i + 1] > (npts - run[2 * i])))
+			return false;
+
+		end = (size_t)run[2 * i] + run[2 * i + 1];
+		total += run[2 * i + 1];
+	}
+
+	return total == nchanged;
+}
+
+/**
+ * Write a span of planes into a buffer, row by row.
+ *   @buf: The buffer.
+ *   @idx: The index of the first point.
+ *   @code, attr: The code and attribute planes.
+ *   @n: The number of points.
+ */
+
+static void frame_span(struct scr_buf_t *buf, size_t idx, const uint32_t *code, const uint16_t *attr, size_t n)
+{
+	size_t i, len, width = buf->box.size.width;
+	struct scr_pt_t *pt;
+
+	if(scr_buf_isplane(buf)) {
+		memcpy(buf->code + idx, code, n * sizeof(uint32_t));
+		memcpy(buf->attr + idx, attr, n * sizeof(uint16_t));
+
+		return;
+	}
+
+	while(n > 0) {
+		len = width - (idx % width);
+		if(len > n)
+			len = n;
+
+		pt = scr_buf_row(buf, idx / width) + (idx % width);
+		for(i = 0; i < len; i++)
+			pt[i] = (struct scr_pt_t){ code[i], scr_prop_unpack(attr[i]) };
+
+		idx += len;
+		code += len;
+		attr += len;
+		n -= len;
+	}
+}
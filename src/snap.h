@@ -0,0 +1,100 @@
+#ifndef SNAP_H
+#define SNAP_H
+
+/*
+ * start header: scr.h
+ */
+
+/* %scr.h% */
+
+/*
+ * structure prototypes
+ */
+
+struct scr_t;
+struct scr_snap_t;
+struct scr_replay_t;
+
+/**
+ * Record kind enumerator.
+ *   @scr_rec_end_e: The end of the recording.
+ *   @scr_rec_frame_e: A frame.
+ *   @scr_rec_input_e: An input event.
+ */
+
+enum scr_rec_e {
+	scr_rec_end_e,
+	scr_rec_frame_e,
+	scr_rec_input_e
+};
+
+/**
+ * Snapshot frame structure. Frames returned by a replay point directly
+ * into the mapped file and are valid until the replay is closed.
+ *   @key: Key frame flag, otherwise a delta against the previous frame.
+ *   @time: The time since the start of the capture in nanoseconds.
+ *   @box: The buffer box.
+ *   @nruns: The number of runs of a delta frame.
+ *   @run: The offset and length pairs of a delta frame.
+ *   @code, attr: The code and packed attribute planes of the changed points.
+ */
+
+struct scr_frame_t {
+	bool key;
+	uint64_t time;
+	struct scr_box_t box;
+
+	uint32_t nruns;
+	const uint32_t *run;
+	const uint32_t *code;
+	const uint16_t *attr;
+};
+
+/**
+ * Input event structure.
+ *   @time: The time since the start of the capture in nanoseconds.
+ *   @key: The key.
+ */
+
+struct scr_input_t {
+	uint64_t time;
+	int32_t key;
+};
+
+
+/*
+ * snapshot function declarations
+ */
+
+struct scr_snap_t *scr_snap_open(const char *path);
+bool scr_snap_close(struct scr_snap_t *snap);
+
+bool scr_snap_write(struct scr_snap_t *snap, struct scr_buf_t *buf);
+bool scr_snap_input(struct scr_snap_t *snap, int32_t key);
+
+/*
+ * replay function declarations
+ */
+
+struct scr_replay_t *scr_replay_open(const char *path);
+void scr_replay_close(struct scr_replay_t *replay);
+
+enum scr_rec_e scr_replay_step(struct scr_replay_t *replay, struct scr_frame_t *frame, struct scr_input_t *input);
+bool scr_replay_next(struct scr_replay_t *replay, struct scr_frame_t *frame);
+void scr_replay_rewind(struct scr_replay_t *replay);
+
+void scr_frame_apply(const struct scr_frame_t *frame, struct scr_buf_t *buf);
+
+/*
+ * playback function declarations
+ */
+
+bool scr_play(struct scr_t *scr, const char *path, bool realtime);
+
+/* %~scr.h% */
+
+/*
+ * end header: scr.h
+ */
+
+#endif
@@ -0,0 +1,512 @@
+#include "common.h"
+#include <string.h>
+#include "buf.h"
+#include "output.h"
+#include "vt.h"
+
+
+/*
+ * terminal emulator definitions
+ */
+
+#define VT_PARAMS 16
+
+/**
+ * Parser state enumerator.
+ *   @vt_ground_e: Printing characters.
+ *   @vt_esc_e: After an escape.
+ *   @vt_csi_e: Within a control sequence.
+ *   @vt_osc_e: Within an operating system command.
+ */
+
+enum vt_e {
+	vt_ground_e,
+	vt_esc_e,
+	vt_csi_e,
+	vt_osc_e
+};
+
+/**
+ * Terminal emulator structure.
+ *   @grid: The screen grid.
+ *   @cursor, save: The cursor and saved cursor.
+ *   @wrap: The pending wrap flag.
+ *   @prop: The current properties.
+ *   @state: The parser state.
+ *   @priv: The private sequence flag.
+ *   @nparams, param: The control sequence parameters.
+ *   @code, need: The partial UTF-8 code and its remaining bytes.
+ */
+
+struct scr_vt_t {
+	struct scr_buf_t *grid;
+
+	struct scr_coord_t cursor, save;
+	bool wrap;
+	struct scr_prop_t prop;
+
+	enum vt_e state;
+	bool priv;
+	unsigned int nparams;
+	unsigned int param[VT_PARAMS];
+
+	uint32_t code;
+	unsigned int need;
+};
+
+
+/*
+ * local function declarations
+ */
+
+static void vt_byte(struct scr_vt_t *vt, uint8_t byte);
+static void vt_put(struct scr_vt_t *vt, uint32_t code);
+static void vt_esc(struct scr_vt_t *vt, uint8_t byte);
+static void vt_csi(struct scr_vt_t *vt, uint8_t byte);
+static void vt_sgr(struct scr_vt_t *vt);
+
+static void vt_move(struct scr_vt_t *vt, int x, int y);
+static void vt_feed(struct scr_vt_t *vt);
+static void vt_erase(struct scr_vt_t *vt, int y, int left, int right);
+
+static unsigned int vt_param(struct scr_vt_t *vt, unsigned int idx, unsigned int def);
+
+
+/**
+ * Create a terminal emulator.
+ *   @size: The screen size.
+ *   &returns: The terminal emulator.
+ */
+
+_export
+struct scr_vt_t *scr_vt_new(struct scr_size_t size)
+{
+	struct scr_vt_t *vt;
+
+	vt = mem_alloc(sizeof(struct scr_vt_t));
+	vt->grid = scr_buf_new((struct scr_box_t){ { 0, 0 }, size });
+	vt->cursor = vt->save = (struct scr_coord_t){ 0, 0 };
+	vt->wrap = false;
+	vt->prop = scr_pt_blank.prop;
+	vt->state = vt_ground_e;
+	vt->priv = false;
+	vt->nparams = 0;
+	vt->code = 0;
+	vt->need = 0;
+
+	return vt;
+}
+
+/**
+ * Delete a terminal emulator.
+ *   @vt: The terminal emulator.
+ */
+
+_export
+void scr_vt_delete(struct scr_vt_t *vt)
+{
+	scr_buf_delete(vt->grid);
+	mem_free(vt);
+}
+
+
+/**
+ * Feed output bytes to the terminal emulator.
+ *   @vt: The terminal emulator.
+ *   @buf: The bytes.
+ *   @len: The number of bytes.
+ */
+
+_export
+void scr_vt_feed(struct scr_vt_t *vt, const char *buf, size_t len)
+{
+	size_t i;
+
+	for(i = 0; i < len; i++)
+		vt_byte(vt, buf[i]);
+}
+
+
+/**
+ * Retrieve the screen grid of the terminal emulator.
+ *   @vt: The terminal emulator.
+ *   &returns: The grid, owned by the emulator.
+ */
+
+_export
+struct scr_buf_t *scr_vt_grid(struct scr_vt_t *vt)
+{
+	return vt->grid;
+}
+
+/**
+ * Retrieve the cursor of the terminal emulator.
+ *   @vt: The terminal emulator.
+ *   &returns: The cursor.
+ */
+
+_export
+struct scr_coord_t scr_vt_cursor(struct scr_vt_t *vt)
+{
+	return vt->cursor;
+}
+
+
+/**
+ * Process a byte.
+ *   @vt: The terminal emulator.
+ *   @byte: The byte.
+ */
+
+static void vt_byte(struct scr_vt_t *vt, uint8_t byte)
+{
+	switch(vt->state) {
+	case vt_esc_e:
+		vt_esc(vt, byte);
+		return;
+
+	case vt_csi_e:
+		vt_csi(vt, byte);
+		return;
+
+	case vt_osc_e:
+		if((byte == '\a') || (byte == '\x1B'))
+			vt->state = (byte == '\x1B') ? vt_esc_e : vt_ground_e;
+
+		return;
+
+	case vt_ground_e:
+		break;
+	}
+
+	if(byte >= 0x80) {
+		if((byte & 0xC0) == 0x80) {
+			if(vt->need == 0)
+				return;
+
+			vt->code = (vt->code << 6) | (byte & 0x3F);
+			if(--vt->need == 0)
+				vt_put(vt, vt->code);
+		}
+		else {
+			vt->need = ((byte & 0xE0) == 0xC0) ? 1 : ((byte & 0xF0) == 0xE0) ? 2 : 3;
+			vt->code = byte & (0x3F >> vt->need);
+		}
+
+		return;
+	}
+
+	vt->need = 0;
+
+	switch(byte) {
+	case '\x1B':
+		vt->state = vt_esc_e;
+		break;
+
+	case '\r':
+		vt_move(vt, 0, vt->cursor.y);
+		break;
+
+	case '\n':
+		vt_feed(vt);
+		break;
+
+	case '\b':
+		vt_move(vt, vt->cursor.x - 1, vt->cursor.y);
+		break;
+
+	case '\t':
+		vt_move(vt, (vt->cursor.x + 8) & ~7, vt->cursor.y);
+		break;
+
+	default:
+		if(byte >= 0x20)
+			vt_put(vt, byte);
+
+		break;
+	}
+}
+
+/**
+ * Print a character at the cursor, wrapping at the right margin.
+ *   @vt: The terminal emulator.
+ *   @code: The code.
+ */
+
+static void vt_put(struct scr_vt_t *vt, uint32_t code)
+{
+	struct scr_size_t size = vt->grid->box.size;
+
+	if((size.width == 0) || (size.height == 0))
+		return;
+
+	if(vt->wrap) {
+		vt_move(vt, 0, vt->cursor.y);
+		vt_feed(vt);
+	}
+
+	scr_buf_set(vt->grid, vt->cursor, (struct scr_pt_t){ code, vt->prop });
+
+	if((vt->cursor.x + 1) < (int)size.width)
+		vt->cursor.x++;
+	else
+		vt->wrap = true;
+}
+
+/**
+ * Process a byte after an escape.
+ *   @vt: The terminal emulator.
+ *   @byte: The byte.
+ */
+
+static void vt_esc(struct scr_vt_t *vt, uint8_t byte)
+{
+	vt->state = vt_ground_e;
+
+	switch(byte) {
+	case '[':
+		vt->state = vt_csi_e;
+		vt->priv = false;
+		vt->nparams = 0;
+		memset(vt->param, 0x00, sizeof(vt->param));
+		break;
+
+	case ']':
+		vt->state = vt_osc_e;
+		break;
+
+	case '7':
+		vt->save = vt->cursor;
+		break;
+
+	case '8':
+		vt_move(vt, vt->save.x, vt->save.y);
+		break;
+
+	case 'c':
+		vt->prop = scr_pt_blank.prop;
+		vt_erase(vt, -1, 0, vt->grid->box.size.width);
+		vt_move(vt, 0, 0);
+		break;
+	}
+}
+
+/**
+ * Process a byte of a control sequence.
+ *   @vt: The terminal emulator.
+ *   @byte: The byte.
+ */
+
+static void vt_csi(struct scr_vt_t *vt, uint8_t byte)
+{
+	int y, width = vt->grid->box.size.width, height = vt->grid->box.size.height;
+
+	if((byte >= '0') && (byte <= '9')) {
+		if(vt->nparams == 0)
+			vt->nparams = 1;
+
+		if(vt->nparams <= VT_PARAMS)
+			vt->param[vt->nparams - 1] = 10 * vt->param[vt->nparams - 1] + (byte - '0');
+
+		return;
+	}
+	else if(byte == ';') {
+		vt->nparams = ((vt->nparams == 0) ? 1 : vt->nparams) + 1;
+		return;
+	}
+	else if(byte == '?') {
+		vt->priv = true;
+		return;
+	}
+	else if((byte < 0x40) || (byte > 0x7E))
+		return;
+
+	vt->state = vt_ground_e;
+
+	switch(byte) {
+	case 'H':
+	case 'f':
+		vt_move(vt, vt_param(vt, 1, 1) - 1, vt_param(vt, 0, 1) - 1);
+		break;
+
+	case 'A':
+		vt_move(vt, vt->cursor.x, vt->cursor.y - vt_param(vt, 0, 1));
+		break;
+
+	case 'B':
+		vt_move(vt, vt->cursor.x, vt->cursor.y + vt_param(vt, 0, 1));
+		break;
+
+	case 'C':
+		vt_move(vt, vt->cursor.x + vt_param(vt, 0, 1), vt->cursor.y);
+		break;
+
+	case 'D':
+		vt_move(vt, vt->cursor.x - vt_param(vt, 0, 1), vt->cursor.y);
+		break;
+
+	case 'G':
+		vt_move(vt, vt_param(vt, 0, 1) - 1, vt->cursor.y);
+		break;
+
+	case 'd':
+		vt_move(vt, vt->cursor.x, vt_param(vt, 0, 1) - 1);
+		break;
+
+	case 'J':
+		switch(vt_param(vt, 0, 0)) {
+		case 0:
+			vt_erase(vt, vt->cursor.y, vt->cursor.x, width);
+			for(y = vt->cursor.y + 1; y < height; y++)
+				vt_erase(vt, y, 0, width);
+
+			break;
+
+		case 1:
+			vt_erase(vt, vt->cursor.y, 0, vt->cursor.x + 1);
+			for(y = 0; y < vt->cursor.y; y++)
+				vt_erase(vt, y, 0, width);
+
+			break;
+
+		default:
+			vt_erase(vt, -1, 0, width);
+			break;
+		}
+
+		break;
+
+	case 'K':
+		switch(vt_param(vt, 0, 0)) {
+		case 0: vt_erase(vt, vt->cursor.y, vt->cursor.x, width); break;
+		case 1: vt_erase(vt, vt->cursor.y, 0, vt->cursor.x + 1); break;
+		default: vt_erase(vt, vt->cursor.y, 0, width); break;
+		}
+
+		break;
+
+	case 'm':
+		vt_sgr(vt);
+		break;
+
+	case 'h':
+	case 'l':
+		if(vt->priv && (vt_param(vt, 0, 0) == 1049)) {
+			vt_erase(vt, -1, 0, width);
+
+			if(byte == 'h')
+				vt->save = vt->cursor;
+			else
+				vt_move(vt, vt->save.x, vt->save.y);
+		}
+
+		break;
+	}
+}
+
+/**
+ * Process a select graphic rendition sequence.
+ *   @vt: The terminal emulator.
+ */
+
+static void vt_sgr(struct scr_vt_t *vt)
+{
+	unsigned int i, val;
+
+	for(i = 0; i < ((vt->nparams == 0) ? 1 : vt->nparams); i++) {
+		val = vt_param(vt, i, 0);
+
+		if(val == 0)
+			vt->prop = scr_pt_blank.prop;
+		else if(val == 1)
+			vt->prop.bold = true;
+		else if(val == 22)
+			vt->prop.bold = false;
+		else if(val == 4)
+			vt->prop.underline = true;
+		else if(val == 24)
+			vt->prop.underline = false;
+		else if(val == 7)
+			vt->prop.neg = true;
+		else if(val == 27)
+			vt->prop.neg = false;
+		else if(((val >= 30) && (val <= 37)) || (val == 39))
+			vt->prop.fg = val - 30;
+		else if(((val >= 40) && (val <= 47)) || (val == 49))
+			vt->prop.bg = val - 40;
+		else if((val == 38) || (val == 48))
+			i += (vt_param(vt, i + 1, 0) == 2) ? 4 : 2;
+	}
+}
+
+
+/**
+ * Move the cursor, clamping to the screen.
+ *   @vt: The terminal emulator.
+ *   @x: The column.
+ *   @y: The row.
+ */
+
+static void vt_move(struct scr_vt_t *vt, int x, int y)
+{
+	int width = vt->grid->box.size.width, height = vt->grid->box.size.height;
+
+	vt->cursor.x = (x < 0) ? 0 : (x >= width) ? (width - 1) : x;
+	vt->cursor.y = (y < 0) ? 0 : (y >= height) ? (height - 1) : y;
+	vt->wrap = false;
+}
+
+/**
+ * Advance the cursor a line, scrolling at the bottom.
+ *   @vt: The terminal emulator.
+ */
+
+static void vt_feed(struct scr_vt_t *vt)
+{
+	struct scr_buf_t *grid = vt->grid;
+	unsigned int width = grid->box.size.width, height = grid->box.size.height;
+
+	vt->wrap = false;
+
+	if((vt->cursor.y + 1) < (int)height) {
+		vt->cursor.y++;
+		return;
+	}
+
+	memmove(grid->pt, grid->pt + width, (size_t)(height - 1) * width * sizeof(struct scr_pt_t));
+	vt_erase(vt, height - 1, 0, width);
+}
+
+/**
+ * Erase part of a row, or the whole screen.
+ *   @vt: The terminal emulator.
+ *   @y: The row, or negative for the whole screen.
+ *   @left, right: The column range.
+ */
+
+static void vt_erase(struct scr_vt_t *vt, int y, int left, int right)
+{
+	struct scr_view_t view = scr_view_new(vt->grid);
+
+	if(y >= 0)
+		view.box = (struct scr_box_t){ { left, y }, { right - left, 1 } };
+
+	scr_view_fill(view, (struct scr_pt_t){ ' ', { scr_default_e, vt->prop.bg, false, false, false } });
+}
+
+
+/**
+ * Retrieve a control sequence parameter.
+ *   @vt: The terminal emulator.
+ *   @idx: The parameter index.
+ *   @def: The default, used for missing or zero parameters.
+ *   &returns: The parameter.
+ */
+
+static unsigned int vt_param(struct scr_vt_t *vt, unsigned int idx, unsigned int def)
+{
+	if((idx >= vt->nparams) || (idx >= VT_PARAMS) || (vt->param[idx] == 0))
+		return def;
+
+	return vt->param[idx];
+}
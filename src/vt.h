@@ -0,0 +1,34 @@
+#ifndef VT_H
+#define VT_H
+
+/*
+ * start header: scr.h
+ */
+
+/* %scr.h% */
+
+/*
+ * structure prototypes
+ */
+
+struct scr_vt_t;
+
+/*
+ * terminal emulator function declarations
+ */
+
+struct scr_vt_t *scr_vt_new(struct scr_size_t size);
+void scr_vt_delete(struct scr_vt_t *vt);
+
+void scr_vt_feed(struct scr_vt_t *vt, const char *buf, size_t len);
+
+struct scr_buf_t *scr_vt_grid(struct scr_vt_t *vt);
+struct scr_coord_t scr_vt_cursor(struct scr_vt_t *vt);
+
+/* %~scr.h% */
+
+/*
+ * end header: scr.h
+ */
+
+#endif
@@ -1,5 +1,8 @@
 #include "../common.h"
 #include "index.h"
+#include "../arena.h"
+#include "../cache.h"
+#include "../fmt.h"
 #include "../output.h"
 #include "../pack.h"
 #include "edit.h"
@@ -18,8 +21,22 @@
  *   @select: The selection handler.
  *   @sel: The selected index.
  *   @key: The selected key.
+ *   @offset: The horizontal scroll offset.
+ *   @nrows: The number of entries shown by the last render.
+ *   @dirty: The dirty flag.
+ *   @fmt: The compiled entry format.
+ *   @cache: Optional. The rendered entry cache.
+ *   @version: The entry version callback, used with the cache.
  *   @find, search: The find and search string.
  *   @edit: The find edit control.
+ *   @arena: Optional. The scratch arena of the find render, reset every
+ *     render.
+ *   @snap: The materialized flag.
+ *   @stale: The stale snapshot flag.
+ *   @hash: Optional. The key hash, null for the key pointer.
+ *   @nkeys, nslots: The number of snapshot keys and hash slots.
+ *   @keys: The snapshot keys in order.
+ *   @slot: The hash slots holding key positions.
  */
 
 struct scr_index_t {
@@ -34,9 +51,33 @@ struct scr_index_t {
 
 	unsigned int sel;
 	void *key;
+	unsigned int offset, nrows;
+	bool dirty;
+	struct scr_fmt_t *fmt;
+	struct scr_cache_t *cache;
+	scr_version_f version;
 
 	char *find, *search;
 	struct scr_edit_t edit;
+	struct scr_arena_t *arena;
+
+	bool snap, stale;
+	scr_hash_f hash;
+	unsigned int nkeys, nslots;
+	void **keys;
+	unsigned int *slot;
+};
+
+
+/**
+ * Array index structure. The index never nests its iterations, so a single
+ * cursor serves every iterator and iterating allocates nothing.
+ *   @arr: The array.
+ *   @cur: The cursor.
+ */
+
+struct arr_t {
+	const char *const *arr, *const *cur;
 };
 
 
@@ -44,19 +85,32 @@ struct scr_index_t {
  * local function declarations
  */
 
-static struct scr_iter_t arr_index(const char *const *arr);
-static struct io_chunk_t arr_iter(const char *const **ptr, void **key);
+static void index_snap(struct scr_index_t *index);
+static void index_clear(struct scr_index_t *index);
+static unsigned int index_find(struct scr_index_t *index, void *key);
+static unsigned int index_pos(struct scr_index_t *index);
+static uint64_t index_hash(struct scr_index_t *index, void *key);
+static unsigned int index_width(struct scr_index_t *index);
+
+static struct scr_iter_t arr_index(struct arr_t *arr);
+static struct io_chunk_t arr_iter(struct arr_t *arr, void **key);
+static void arr_proc(struct io_output_t output, const char *str);
+static void def_delete(void *ref);
 
 /*
  * local variables
  */
 
-static const struct scr_iter_i arr_iface = { (scr_iter_f)arr_iter, mem_free };
+#define INDEX_SCROLL 8
+
+static const struct scr_iter_i arr_iface = { (scr_iter_f)arr_iter, def_delete };
 
 static const struct scr_widget_i index_iface = {
 	(scr_render_f)scr_index_render,
 	(scr_keypress_f)scr_index_keypress,
-	(delete_f)scr_index_delete
+	(delete_f)scr_index_delete,
+	(scr_dirty_f)scr_index_dirty,
+	(scr_invalidate_f)scr_index_invalidate
 };
 
 static void *def_copy(void *ref)
@@ -92,8 +146,20 @@ struct scr_index_t *scr_index_new(scr_index_f func, void *arg)
 	index->select = (struct scr_select_h){ NULL, NULL };
 	index->sel = 0;
 	index->key = NULL;
+	index->offset = index->nrows = 0;
+	index->dirty = true;
+	index->fmt = scr_fmt_new("%C%C%C\n");
+	index->cache = NULL;
+	index->version = NULL;
 	index->find = NULL;
 	index->search = NULL;
+	index->arena = NULL;
+	index->snap = false;
+	index->stale = true;
+	index->hash = NULL;
+	index->nkeys = index->nslots = 0;
+	index->keys = NULL;
+	index->slot = NULL;
 
 	iter = func(arg);
 	scr_iter_next(iter, &index->key);
@@ -104,15 +170,25 @@ struct scr_index_t *scr_index_new(scr_index_f func, void *arg)
 }
 
 /**
- * Indexed list function.
- *   @arg: The argument.
- *   &returns: The iterator.
+ * Create an index over a null-terminated string array. Entries are cached
+ * by the hash of their string.
+ *   @arr: The array.
+ *   &returns: The index.
  */
 
 _export
 struct scr_index_t *scr_index_arr(const char *const *arr)
 {
-	return scr_index_new((scr_index_f)arr_index, (void *)arr);
+	struct arr_t *state;
+	struct scr_index_t *index;
+
+	state = mem_alloc(sizeof(struct arr_t));
+	*state = (struct arr_t){ arr, arr };
+
+	index = scr_index_new((scr_index_f)arr_index, state);
+	scr_index_cache(index, scr_cache_str, SCR_CACHE_SIZE);
+
+	return index;
 }
 
 
@@ -129,6 +205,18 @@ void scr_index_delete(struct scr_index_t *index)
 
 	mem_delete(index->find);
 	mem_delete(index->search);
+	scr_fmt_delete(index->fmt);
+
+	if(index->cache != NULL)
+		scr_cache_delete(index->cache);
+
+	if(index->arena != NULL)
+		scr_arena_delete(index->arena);
+
+	if(index->func == (scr_index_f)arr_index)
+		mem_free(index->arg);
+
+	index_clear(index);
 	mem_free(index);
 }
 
@@ -162,13 +250,18 @@ void scr_index_render(struct scr_index_t *index, struct scr_view_t view, bool fo
 	struct io_chunk_t chunk;
 	compare_f compare = index->compare;
 
+	index->dirty = false;
+
 	if(index->find == NULL) {
 		unsigned int sel;
 		struct scr_output_t output = scr_output_view(view);
 
 		sel = index->sel;
+		output.offset = index->offset;
 
-		if(index->key != NULL) {
+		if(index->snap)
+			sel = index_pos(index);
+		else if(index->key != NULL) {
 			iter = index->func(index->arg);
 
 			for(i = 0; !io_chunk_isnull(scr_iter_next(iter, &key)); i++) {
@@ -184,8 +277,16 @@ void scr_index_render(struct scr_index_t *index, struct scr_view_t view, bool fo
 
 		iter = index->func(index->arg);
 
-		for(i = 0; !io_chunk_isnull(chunk = scr_iter_next(iter, &key)); i++)
-			scr_printf(&output, "%C%C%C\n", scr_chunk_neg((sel == i) && focus), chunk, scr_chunk_neg(false));
+		for(i = 0; !scr_output_done(&output) && !io_chunk_isnull(chunk = scr_iter_next(iter, &key)); i++) {
+			if((index->cache == NULL) || ((sel == i) && focus))
+				scr_fmt_exec(index->fmt, &output, scr_chunk_neg((sel == i) && focus), chunk, scr_chunk_neg(false));
+			else {
+				scr_cache_chunk(index->cache, &output, view, key, index->version(key), chunk);
+				scr_output_write(&output, "\n", 1);
+			}
+		}
+
+		index->nrows = i;
 
 		if((i == 0) && !io_chunk_isnull(chunk = index->empty))
 			scr_printf(&output, "%C", chunk);
@@ -199,10 +300,15 @@ void scr_index_render(struct scr_index_t *index, struct scr_view_t view, bool fo
 		output = scr_output_view(status.front);
 		iter = index->func(index->arg);
 
-		for(i = 0; !io_chunk_isnull(chunk = scr_iter_next(iter, &key)); i++) {
+		if(index->arena == NULL)
+			index->arena = scr_arena_new(0);
+
+		scr_arena_reset(index->arena);
+
+		for(i = 0; !scr_output_done(&output) && !io_chunk_isnull(chunk = scr_iter_next(iter, &key)); i++) {
 			if(*index->find != '\0') {
 				size_t len = str_len(index->find);
-				char *sub, *str, entry[str_lprintf("%C", chunk) + 1];
+				char *sub, *str, *entry = scr_arena_alloc(index->arena, str_lprintf("%C", chunk) + 1);
 
 				str_printf(entry, "%C", chunk);
 
@@ -237,6 +343,8 @@ void scr_index_render(struct scr_index_t *index, struct scr_view_t view, bool fo
 _export
 void scr_index_keypress(struct scr_index_t *index, int32_t key, struct scr_context_t context)
 {
+	index->dirty = true;
+
 	if(index->find == NULL) {
 		switch(key) {
 		case ' ':
@@ -265,6 +373,18 @@ void scr_index_keypress(struct scr_index_t *index, int32_t key, struct scr_conte
 			scr_index_next(index);
 			break;
 
+		case 'h':
+		case scr_left_e:
+			index->offset = (index->offset > INDEX_SCROLL) ? (index->offset - INDEX_SCROLL) : 0;
+			break;
+
+		case 'l':
+		case scr_right_e:
+			if((index->offset + INDEX_SCROLL) < index_width(index))
+				index->offset += INDEX_SCROLL;
+
+			break;
+
 		case '/':
 			scr_edit_init(&index->edit, &index->find);
 			break;
@@ -285,6 +405,32 @@ void scr_index_keypress(struct scr_index_t *index, int32_t key, struct scr_conte
 }
 
 
+/**
+ * Determine if the index is dirty.
+ *   @index: The index.
+ *   &returns: True if dirty, false otherwise.
+ */
+
+_export
+bool scr_index_dirty(struct scr_index_t *index)
+{
+	return index->dirty;
+}
+
+/**
+ * Invalidate the index, forcing it to be rendered again. Required after
+ * the entries of the index change.
+ *   @index: The index.
+ */
+
+_export
+void scr_index_invalidate(struct scr_index_t *index)
+{
+	index->dirty = true;
+	index->stale = true;
+}
+
+
 /**
  * Set the key callback functions.
  *   @index: The index.
@@ -296,9 +442,12 @@ void scr_index_keypress(struct scr_index_t *index, int32_t key, struct scr_conte
 _export
 void scr_index_keys(struct scr_index_t *index, compare_f compare, copy_f copy, delete_f delete)
 {
+	index_clear(index);
+
 	index->compare = compare ?: compare_ptr;
 	index->copy = copy ?: def_copy;
 	index->delete = delete ?: def_delete;
+	index->dirty = true;
 }
 
 /**
@@ -311,6 +460,47 @@ _export
 void scr_index_empty(struct scr_index_t *index, struct io_chunk_t empty)
 {
 	index->empty = empty;
+	index->dirty = true;
+}
+
+/**
+ * Cache rendered entries of the index, keyed by their key. An entry is only
+ * rendered again once its version changes.
+ *   @index: The index.
+ *   @version: Optional. The version callback, null to disable caching.
+ *   @limit: The maximum number of bytes cached.
+ */
+
+_export
+void scr_index_cache(struct scr_index_t *index, scr_version_f version, size_t limit)
+{
+	if(index->cache != NULL)
+		scr_cache_delete(index->cache);
+
+	index->cache = version ? scr_cache_new(limit) : NULL;
+	index->version = version;
+	index->dirty = true;
+}
+
+/**
+ * Materialize the index into a snapshot of its keys and a hash from key to
+ * position, making navigation and selection lookup constant time. The
+ * snapshot is taken on first use and only taken again after
+ * 'scr_index_invalidate', which must be called once the entries change.
+ *   @index: The index.
+ *   @enable: The materialized flag.
+ *   @hash: Optional. The key hash consistent with the key comparison, null
+ *     to hash the key pointer.
+ */
+
+_export
+void scr_index_materialize(struct scr_index_t *index, bool enable, scr_hash_f hash)
+{
+	index_clear(index);
+
+	index->snap = enable;
+	index->stale = true;
+	index->hash = hash;
 }
 
 /**
@@ -343,6 +533,32 @@ unsigned int scr_index_cur(struct scr_index_t *index, void **key, char **str)
 	struct io_chunk_t chunk, sel = io_chunk_null;
 	compare_f compare = index->compare;
 
+	if(index->snap) {
+		unsigned int pos = index_pos(index);
+
+		if(key)
+			*key = (pos < index->nkeys) ? index->copy(index->keys[pos]) : NULL;
+
+		if(str) {
+			*str = NULL;
+
+			if(pos < index->nkeys) {
+				iter = index->func(index->arg);
+
+				for(i = 0; !io_chunk_isnull(chunk = scr_iter_next(iter, &bykey)); i++) {
+					if(i == pos) {
+						*str = io_chunk_proc_str(chunk);
+						break;
+					}
+				}
+
+				scr_iter_delete(iter);
+			}
+		}
+
+		return (pos < index->nkeys) ? pos : UINT_MAX;
+	}
+
 	iter = index->func(index->arg);
 
 	for(i = 0; !io_chunk_isnull(chunk = scr_iter_next(iter, &bykey)); i++) {
@@ -378,6 +594,7 @@ static void index_update(struct scr_index_t *index, unsigned int sel, void *key)
 
 	index->sel = sel;
 	index->key = key ? index->copy(key) : NULL;
+	index->dirty = true;
 }
 
 /**
@@ -394,6 +611,14 @@ void scr_index_prev(struct scr_index_t *index)
 	void *key = NULL, *bykey = NULL, *byidx = NULL;
 	compare_f compare = index->compare;
 
+	if(index->snap) {
+		sel = index_pos(index);
+		if((sel > 0) && (sel < index->nkeys))
+			index_update(index, sel - 1, index->keys[sel - 1]);
+
+		return;
+	}
+
 	iter = index->func(index->arg);
 
 	while(!io_chunk_isnull(chunk = scr_iter_next(iter, &key))) {
@@ -427,6 +652,14 @@ void scr_index_next(struct scr_index_t *index)
 	void *key = NULL, *bykey = NULL, *byidx = NULL;
 	compare_f compare = index->compare;
 
+	if(index->snap) {
+		sel = index_pos(index);
+		if((sel + 1) < index->nkeys)
+			index_update(index, sel + 1, index->keys[sel + 1]);
+
+		return;
+	}
+
 	iter = index->func(index->arg);
 
 	while(!io_chunk_isnull(chunk = scr_iter_next(iter, &key))) {
@@ -447,33 +680,219 @@ void scr_index_next(struct scr_index_t *index)
 }
 
 /**
- * Create an iterator for the array index.
- *   @arr: The array.
+ * Take a snapshot of the keys if stale, building the position hash.
+ *   @index: The index.
+ */
+
+static void index_snap(struct scr_index_t *index)
+{
+	void *key;
+	uint64_t hash;
+	unsigned int i, n, cap = 0;
+	struct scr_iter_t iter;
+
+	if(!index->stale)
+		return;
+
+	index_clear(index);
+
+	iter = index->func(index->arg);
+
+	for(n = 0; !io_chunk_isnull(scr_iter_next(iter, &key)); n++) {
+		if(n == cap) {
+			cap = cap ? (2 * cap) : 64;
+			index->keys = mem_realloc(index->keys, cap * sizeof(void *));
+		}
+
+		index->keys[n] = index->copy(key);
+	}
+
+	scr_iter_delete(iter);
+
+	for(index->nslots = 16; index->nslots < 2 * n; index->nslots *= 2);
+
+	index->nkeys = n;
+	index->slot = mem_alloc(index->nslots * sizeof(unsigned int));
+
+	for(i = 0; i < index->nslots; i++)
+		index->slot[i] = UINT_MAX;
+
+	for(i = 0; i < n; i++) {
+		if(index_find(index, index->keys[i]) != UINT_MAX)
+			continue;
+
+		hash = index_hash(index, index->keys[i]);
+		while(index->slot[hash & (index->nslots - 1)] != UINT_MAX)
+			hash++;
+
+		index->slot[hash & (index->nslots - 1)] = i;
+	}
+
+	index->stale = false;
+}
+
+/**
+ * Release the snapshot of the keys.
+ *   @index: The index.
+ */
+
+static void index_clear(struct scr_index_t *index)
+{
+	unsigned int i;
+
+	for(i = 0; i < index->nkeys; i++)
+		index->delete(index->keys[i]);
+
+	mem_delete(index->keys);
+	mem_delete(index->slot);
+
+	index->nkeys = index->nslots = 0;
+	index->keys = NULL;
+	index->slot = NULL;
+	index->stale = true;
+}
+
+/**
+ * Find the position of a key in the snapshot.
+ *   @index: The index.
+ *   @key: The key.
+ *   &returns: The first position of the key, or 'UINT_MAX' if not found.
+ */
+
+static unsigned int index_find(struct scr_index_t *index, void *key)
+{
+	unsigned int pos;
+	uint64_t hash;
+
+	if(index->nslots == 0)
+		return UINT_MAX;
+
+	hash = index_hash(index, key);
+
+	while((pos = index->slot[hash & (index->nslots - 1)]) != UINT_MAX) {
+		if(!index->compare(index->keys[pos], key))
+			return pos;
+
+		hash++;
+	}
+
+	return UINT_MAX;
+}
+
+/**
+ * Retrieve the selected position from the snapshot, by key if present and
+ * by position otherwise.
+ *   @index: The index.
+ *   &returns: The position, at least the number of keys if empty.
+ */
+
+static unsigned int index_pos(struct scr_index_t *index)
+{
+	unsigned int pos = UINT_MAX;
+
+	index_snap(index);
+
+	if(index->key != NULL)
+		pos = index_find(index, index->key);
+
+	if(pos == UINT_MAX)
+		pos = (index->sel < index->nkeys) ? index->sel : (index->nkeys ? (index->nkeys - 1) : 0);
+
+	return pos;
+}
+
+/**
+ * Hash a key of the index.
+ *   @index: The index.
+ *   @key: The key.
+ *   &returns: The hash.
+ */
+
+static uint64_t index_hash(struct scr_index_t *index, void *key)
+{
+	uint64_t hash;
+
+	if(index->hash != NULL)
+		hash = index->hash(key);
+	else
+		hash = (uintptr_t)key;
+
+	return (hash * 0x9e3779b97f4a7c15) >> 32;
+}
+
+/**
+ * Measure the widest entry shown by the last render, bounding the
+ * horizontal scroll offset.
+ *   @index: The index.
+ *   &returns: The width.
+ */
+
+static unsigned int index_width(struct scr_index_t *index)
+{
+	void *key;
+	unsigned int i, width = 0;
+	struct scr_box_t box;
+	struct scr_iter_t iter;
+	struct io_chunk_t chunk;
+
+	iter = index->func(index->arg);
+
+	for(i = 0; (i < index->nrows) && !io_chunk_isnull(chunk = scr_iter_next(iter, &key)); i++) {
+		box = scr_measure(chunk, 0);
+		if((box.coord.x + box.size.width) > width)
+			width = box.coord.x + box.size.width;
+	}
+
+	scr_iter_delete(iter);
+
+	return width;
+}
+
+
+/**
+ * Create an iterator for the array index, rewinding the cursor.
+ *   @arr: The array state.
  *   &returns: The iterator.
  */
 
-static struct scr_iter_t arr_index(const char *const *arr)
+static struct scr_iter_t arr_index(struct arr_t *arr)
 {
-	const char *const **ptr;
+	arr->cur = arr->arr;
 
-	ptr = mem_alloc(sizeof(void *));
-	*ptr = arr;
-	
-	return (struct scr_iter_t){ (void *)ptr, &arr_iface };
+	return (struct scr_iter_t){ arr, &arr_iface };
 }
 
 /**
  * Continue over the array index iterator.
- *   @ptr: The array pointer.
+ *   @arr: The array state.
  *   @key: The current key.
  *   &returns: The current chunk or null.
  */
 
-static struct io_chunk_t arr_iter(const char *const **ptr, void **key)
+static struct io_chunk_t arr_iter(struct arr_t *arr, void **key)
 {
-	*key = (void *)**ptr;
+	*key = (void *)*arr->cur;
+
+	return *arr->cur ? (struct io_chunk_t){ (io_chunk_f)arr_proc, (void *)*(arr->cur++) } : io_chunk_null;
+}
+
+/**
+ * Process an array entry chunk. Leading ASCII before the horizontal scroll
+ * offset is seeked over instead of written.
+ *   @output: The output.
+ *   @str: The entry string.
+ */
+
+static void arr_proc(struct io_output_t output, const char *str)
+{
+	unsigned int n, skip = scr_chunk_skip(output);
+
+	for(n = 0; (n < skip) && (str[n] != '\0') && (str[n] != '\n') && ((uint8_t)str[n] < 0x80); n++);
+
+	if(n > 0)
+		scr_chunk_seek(output, n);
 
-	return **ptr ? io_chunk_str(*((*ptr)++)) : io_chunk_null;
+	io_printf(output, "%s", str + n);
 }
 
 
@@ -24,6 +24,14 @@ struct scr_select_h;
 
 typedef struct scr_iter_t (*scr_index_f)(void *arg);
 
+/**
+ * Key hash function, consistent with the key comparison.
+ *   @key: The key.
+ *   &returns: The hash.
+ */
+
+typedef uint64_t (*scr_hash_f)(const void *key);
+
 
 /*
  * index function declarations
@@ -37,9 +45,13 @@ struct scr_widget_t scr_index_widget(struct scr_index_t *index);
 
 void scr_index_render(struct scr_index_t *index, struct scr_view_t view, bool focus);
 void scr_index_keypress(struct scr_index_t *index, int32_t key, struct scr_context_t context);
+bool scr_index_dirty(struct scr_index_t *index);
+void scr_index_invalidate(struct scr_index_t *index);
 
 void scr_index_keys(struct scr_index_t *index, compare_f compare, copy_f copy, delete_f delete);
 void scr_index_empty(struct scr_index_t *index, struct io_chunk_t empty);
+void scr_index_cache(struct scr_index_t *index, scr_version_f version, size_t limit);
+void scr_index_materialize(struct scr_index_t *index, bool enable, scr_hash_f hash);
 void scr_index_select(struct scr_index_t *index, struct scr_select_h handler);
 
 unsigned int scr_index_cur(struct scr_index_t *index, void **key, char **str);
@@ -1,17 +1,27 @@
 #include "../common.h"
 #include "pane.h"
+#include "../buf.h"
+#include "../dlist.h"
 #include "../pack.h"
 #include "../output.h"
 #include "widget.h"
 
 
 /**
- * Pane widget structure.
+ * Pane widget structure. Child widgets that track their own changes are
+ * rendered onto a cached buffer, and only rendered again once dirty or
+ * once the size or focus changes.
  *   @widget: The child widget.
+ *   @buf: The cached rendering, null if none.
+ *   @focus: The focus of the cached rendering.
+ *   @dirty: The dirty flag.
  */
 
 struct scr_pane_t {
 	struct scr_widget_t widget;
+
+	struct scr_buf_t *buf;
+	bool focus, dirty;
 };
 
 
@@ -20,6 +30,7 @@ struct scr_pane_t {
  *   @type: The split type.
  *   @front, back: The front and back panes.
  *   @size: The size.
+ *   @divider: The display list of the divider.
  *   @focus: The front focus flag.
  */
 
@@ -28,11 +39,18 @@ struct scr_split_t {
 	struct scr_pane_t *front, *back;
 
 	double size;
+	struct scr_dlist_t *divider;
 
 	bool focus;
 };
 
 
+/*
+ * local function declarations
+ */
+
+static void split_divider(struct scr_split_t *split, struct scr_view_t view, char ch);
+
 /*
  * local variables
  */
@@ -40,13 +58,17 @@ struct scr_split_t {
 static struct scr_widget_i pane_iface = {
 	(scr_render_f)scr_pane_render,
 	(scr_keypress_f)scr_pane_keypress,
-	(delete_f)scr_pane_delete
+	(delete_f)scr_pane_delete,
+	(scr_dirty_f)scr_pane_dirty,
+	(scr_invalidate_f)scr_pane_invalidate
 };
 
 static struct scr_widget_i split_iface = {
 	(scr_render_f)scr_split_render,
 	(scr_keypress_f)scr_split_keypress,
-	(delete_f)scr_split_delete
+	(delete_f)scr_split_delete,
+	(scr_dirty_f)scr_split_dirty,
+	(scr_invalidate_f)scr_split_invalidate
 };
 
 
@@ -62,6 +84,9 @@ struct scr_pane_t *scr_pane_new(struct scr_widget_t widget)
 
 	pane = mem_alloc(sizeof(struct scr_pane_t));
 	pane->widget = widget;
+	pane->buf = NULL;
+	pane->focus = false;
+	pane->dirty = true;
 
 	return pane;
 }
@@ -75,6 +100,7 @@ _export
 void scr_pane_delete(struct scr_pane_t *pane)
 {
 	scr_widget_delete(pane->widget);
+	scr_buf_replace(&pane->buf, NULL);
 	mem_free(pane);
 }
 
@@ -101,7 +127,31 @@ struct scr_widget_t scr_pane_widget(struct scr_pane_t *pane)
 
 void scr_pane_render(struct scr_pane_t *pane, struct scr_view_t view, bool focus)
 {
-	scr_widget_render(pane->widget, view, focus);
+	struct scr_buf_t *buf = pane->buf;
+
+	if((pane->widget.iface->dirty == NULL) || (pane->widget.iface == &split_iface)) {
+		scr_buf_replace(&pane->buf, NULL);
+		scr_widget_render(pane->widget, view, focus);
+		pane->dirty = false;
+
+		return;
+	}
+
+	if((buf == NULL) || (buf->box.size.width != view.box.size.width) || (buf->box.size.height != view.box.size.height)) {
+		buf = scr_buf_new((struct scr_box_t){ { 0, 0 }, view.box.size });
+		scr_buf_replace(&pane->buf, buf);
+		pane->dirty = true;
+	}
+
+	if(pane->dirty || (pane->focus != focus) || scr_widget_dirty(pane->widget)) {
+		scr_buf_clear(buf);
+		scr_widget_render(pane->widget, scr_view_new(buf), focus);
+
+		pane->focus = focus;
+		pane->dirty = false;
+	}
+
+	scr_blit(view, buf);
 }
 
 /**
@@ -116,6 +166,31 @@ void scr_pane_keypress(struct scr_pane_t *pane, int32_t key, struct scr_context_
 	scr_widget_keypress(pane->widget, key, context);
 }
 
+/**
+ * Determine if a pane is dirty. Panes holding a widget without dirty
+ * tracking are always dirty, since their content may change at any time.
+ *   @pane: The pane.
+ *   &returns: True if dirty, false otherwise.
+ */
+
+_export
+bool scr_pane_dirty(struct scr_pane_t *pane)
+{
+	return pane->dirty || (pane->widget.iface->dirty == NULL) || scr_widget_dirty(pane->widget);
+}
+
+/**
+ * Invalidate a pane and its child widget.
+ *   @pane: The pane.
+ */
+
+_export
+void scr_pane_invalidate(struct scr_pane_t *pane)
+{
+	pane->dirty = true;
+	scr_widget_invalidate(pane->widget);
+}
+
 
 /**
  * Retrieve the child widget.
@@ -139,6 +214,7 @@ _export
 void scr_pane_set(struct scr_pane_t *pane, struct scr_widget_t widget)
 {
 	pane->widget = widget;
+	pane->dirty = true;
 }
 
 /**
@@ -151,6 +227,7 @@ _export
 void scr_pane_replace(struct scr_pane_t *pane, struct scr_widget_t widget)
 {
 	scr_widget_replace(&pane->widget, widget);
+	pane->dirty = true;
 }
 
 
@@ -210,6 +287,7 @@ struct scr_split_t *scr_split_new(enum scr_split_e type, float size, struct scr_
 	split->size = size;
 	split->front = front;
 	split->back = back;
+	split->divider = scr_dlist_new();
 	split->focus = true;
 
 	return split;
@@ -225,6 +303,7 @@ void scr_split_delete(struct scr_split_t *split)
 {
 	scr_pane_delete(split->front);
 	scr_pane_delete(split->back);
+	scr_dlist_delete(split->divider);
 	mem_free(split);
 }
 
@@ -259,7 +338,7 @@ void scr_split_render(struct scr_split_t *split, struct scr_view_t view, bool fo
 		bottom = view.box.size.height - top - 1;
 
 		scr_pane_render(split->front, scr_pack_vert(&view, top), focus && split->focus);
-		scr_view_fill_code(scr_pack_vert(&view, 1), '-');
+		split_divider(split, scr_pack_vert(&view, 1), '-');
 		scr_pane_render(split->back, scr_pack_vert(&view, bottom), focus && !split->focus);
 	}
 	else if(split->type == scr_split_vert_e) {
@@ -269,13 +348,54 @@ void scr_split_render(struct scr_split_t *split, struct scr_view_t view, bool fo
 		right = view.box.size.width - left - 1;
 
 		scr_pane_render(split->front, scr_pack_horiz(&view, left), focus && split->focus);
-		scr_view_fill_code(scr_pack_horiz(&view, 1), '|');
+		split_divider(split, scr_pack_horiz(&view, 1), '|');
 		scr_pane_render(split->back, scr_pack_horiz(&view, right), focus && !split->focus);
 	}
 	else
 		_fatal("Invalid split type.");
 }
 
+/**
+ * Render the divider of a split through its display list, so that it is
+ * only rasterized again once its size changes.
+ *   @split: The split.
+ *   @view: The divider view.
+ *   @ch: The divider character.
+ */
+
+static void split_divider(struct scr_split_t *split, struct scr_view_t view, char ch)
+{
+	struct scr_render_t render;
+
+	render = scr_dlist_begin(split->divider, view.box.size);
+	scr_render_fill(&render, ch);
+	scr_dlist_end(split->divider, view);
+}
+
+/**
+ * Determine if either pane of a split is dirty.
+ *   @split: The split.
+ *   &returns: True if dirty, false otherwise.
+ */
+
+_export
+bool scr_split_dirty(struct scr_split_t *split)
+{
+	return scr_pane_dirty(split->front) || scr_pane_dirty(split->back);
+}
+
+/**
+ * Invalidate both panes of a split.
+ *   @split: The split.
+ */
+
+_export
+void scr_split_invalidate(struct scr_split_t *split)
+{
+	scr_pane_invalidate(split->front);
+	scr_pane_invalidate(split->back);
+}
+
 /**
  * Handle a keypress on a split.
  *   @ref: The reference.
@@ -358,10 +478,12 @@ struct scr_pane_t *scr_split_close(struct scr_pane_t **pane, struct scr_split_t
 		if(sub != NULL)
 			return scr_split_close(&split->front, sub);
 
+		scr_buf_replace(&(*pane)->buf, NULL);
 		mem_free(*pane);
 		*pane = split->back;
 
 		scr_pane_delete(split->front);
+		scr_dlist_delete(split->divider);
 		mem_free(split);
 	}
 	else {
@@ -369,10 +491,12 @@ struct scr_pane_t *scr_split_close(struct scr_pane_t **pane, struct scr_split_t
 		if(sub != NULL)
 			return scr_split_close(&split->back, sub);
 
+		scr_buf_replace(&(*pane)->buf, NULL);
 		mem_free(*pane);
 		*pane = split->front;
 
 		scr_pane_delete(split->back);
+		scr_dlist_delete(split->divider);
 		mem_free(split);
 	}
 
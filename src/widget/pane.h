@@ -39,6 +39,8 @@ struct scr_widget_t scr_pane_widget(struct scr_pane_t *pane);
 
 void scr_pane_render(struct scr_pane_t *pane, struct scr_view_t view, bool focus);
 void scr_pane_keypress(struct scr_pane_t *pane, int32_t key, struct scr_context_t context);
+bool scr_pane_dirty(struct scr_pane_t *pane);
+void scr_pane_invalidate(struct scr_pane_t *pane);
 
 struct scr_widget_t scr_pane_get(struct scr_pane_t *pane);
 void scr_pane_set(struct scr_pane_t *pane, struct scr_widget_t widget);
@@ -60,6 +62,8 @@ struct scr_widget_t scr_split_widget(struct scr_split_t *split);
 
 void scr_split_render(struct scr_split_t *split, struct scr_view_t view, bool focus);
 void scr_split_keypress(struct scr_split_t *split, int32_t key, struct scr_context_t context);
+bool scr_split_dirty(struct scr_split_t *split);
+void scr_split_invalidate(struct scr_split_t *split);
 
 struct scr_pane_t *scr_split_tab(struct scr_split_t *split);
 struct scr_pane_t *scr_split_rtab(struct scr_split_t *split);
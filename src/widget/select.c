@@ -1,5 +1,6 @@
 #include "../common.h"
 #include "select.h"
+#include "../cache.h"
 #include "../output.h"
 #include "widget.h"
 
@@ -12,6 +13,8 @@
  *   @key: The current key.
  *   @index: The current index.
  *   @empty: The empty message.
+ *   @cache: Optional. The rendered entry cache.
+ *   @version: The entry version callback, used with the cache.
  */
 
 struct scr_select_t {
@@ -22,6 +25,9 @@ struct scr_select_t {
 	unsigned int index;
 
 	struct io_chunk_t empty;
+
+	struct scr_cache_t *cache;
+	scr_version_f version;
 };
 
 
@@ -43,6 +49,8 @@ struct scr_select_t *scr_select_new(struct enum_t iter, struct io_filter_t filte
 	select->index = 0;
 	select->key = NULL;
 	select->empty = io_chunk_null;
+	select->cache = NULL;
+	select->version = NULL;
 
 	return select;
 }
@@ -57,6 +65,10 @@ void scr_select_delete(struct scr_select_t *select)
 {
 	enum_delete(select->iter);
 	io_filter_delete(select->filter);
+
+	if(select->cache != NULL)
+		scr_cache_delete(select->cache);
+
 	mem_free(select);
 }
 
@@ -96,8 +108,14 @@ void scr_select_render(struct scr_select_t *select, struct scr_view_t view, bool
 		if(sel == NULL)
 			sel = llist_back(&list);
 
-		while((key = llist_front_remove(&list)) != NULL)
-			scr_printf(&output, "%C%C%C\n", scr_chunk_neg(focus && (key == sel)), io_filter_apply(select->filter, key), scr_chunk_neg(false));
+		while((key = llist_front_remove(&list)) != NULL) {
+			if((select->cache == NULL) || (focus && (key == sel)))
+				scr_printf(&output, "%C%C%C\n", scr_chunk_neg(focus && (key == sel)), io_filter_apply(select->filter, key), scr_chunk_neg(false));
+			else {
+				scr_cache_chunk(select->cache, &output, view, key, select->version(key), io_filter_apply(select->filter, key));
+				scr_output_write(&output, "\n", 1);
+			}
+		}
 	}
 	else if(!io_chunk_isnull(select->empty))
 		scr_printf(&output, "%C\n", select->empty);
@@ -142,6 +160,25 @@ void scr_select_empty(struct scr_select_t *select, struct io_chunk_t empty)
 }
 
 
+/**
+ * Cache rendered entries of the select widget, keyed by their key. An entry
+ * is only rendered again once its version changes.
+ *   @select: The select widget.
+ *   @version: Optional. The version callback, null to disable caching.
+ *   @limit: The maximum number of bytes cached.
+ */
+
+_export
+void scr_select_cache(struct scr_select_t *select, scr_version_f version, size_t limit)
+{
+	if(select->cache != NULL)
+		scr_cache_delete(select->cache);
+
+	select->cache = version ? scr_cache_new(limit) : NULL;
+	select->version = version;
+}
+
+
 /**
  * Retrieve the current selection.
  *   @select: The select widget.
@@ -24,6 +24,7 @@ void scr_select_render(struct scr_select_t *select, struct scr_view_t view, bool
 void scr_select_keypress(struct scr_select_t *select, int32_t key, struct scr_context_t context);
 
 void scr_select_empty(struct scr_select_t *select, struct io_chunk_t empty);
+void scr_select_cache(struct scr_select_t *select, scr_version_f version, size_t limit);
 
 void *scr_select_cur(struct scr_select_t *select);
 void scr_select_prev(struct scr_select_t *select);
@@ -1,7 +1,7 @@
 #include "../common.h"
 #include "ui.h"
-#include "../accum.h"
 #include "../buf.h"
+#include "../layer.h"
 #include "../output.h"
 #include "../pack.h"
 #include "edit.h"
@@ -15,11 +15,16 @@
  * UI widget structure.
  *   @pane, cur: The child and current pane.
  *   @raw: The raw flags.
- *   @msg, help: Message and help chunk.
+ *   @msg, help: The message and help, wrapped to the width.
+ *   @src: The unwrapped message and help, wrapped again on resize.
  *   @prompt: The prompt edit widget.
  *   @cmd: The command handler.
  *   @resp: The response handler.
  *   @delay, expire: The message delay and expiry.
+ *   @comp: The layer compositor.
+ *   @base, overlay: The base and overlay damage flags.
+ *   @focus: The focus of the last base render.
+ *   @width: The width of the last resize, used to wrap messages.
  *   @func: The UI function.
  *   @arg: The argument.
  */
@@ -29,7 +34,7 @@ struct scr_ui_t {
 
 	char *buf;
 	bool raw;
-	struct scr_buf_t *msg, *help;
+	struct scr_buf_t *msg, *help, *src[2];
 	struct scr_edit_t prompt;
 
 	struct scr_cmd_h cmd;
@@ -37,6 +42,10 @@ struct scr_ui_t {
 
 	uint64_t delay, expire;
 
+	struct scr_comp_t *comp;
+	bool base, overlay, focus;
+	unsigned int width;
+
 	scr_ui_f func;
 	void *arg;
 };
@@ -46,6 +55,7 @@ struct scr_ui_t {
  * local function declarations
  */
 
+static void ui_wrap(struct scr_ui_t *ui);
 static void error_proc(struct io_output_t output, const struct io_chunk_t *error);
 
 static bool cmd_resp(int32_t key, struct scr_context_t context, struct scr_complete_h complete, void *arg);
@@ -80,13 +90,16 @@ struct scr_ui_t *scr_ui_new(scr_ui_f func, void *arg)
 
 	ui = mem_alloc(sizeof(struct scr_ui_t));
 	ui->raw = false;
-	ui->msg = NULL;
-	ui->help = NULL;
+	ui->msg = ui->help = ui->src[0] = ui->src[1] = NULL;
 	ui->func = func;
 	ui->arg = arg;
 	ui->resp = scr_resp_null;
 	ui->cmd = (struct scr_cmd_h){ NULL, NULL };
 	ui->pane = ui->cur = scr_pane_new(func(arg));
+	ui->comp = scr_comp_new();
+	ui->base = ui->overlay = true;
+	ui->focus = false;
+	ui->width = 0;
 
 	return ui;
 }
@@ -108,16 +121,28 @@ void scr_ui_delete(struct scr_ui_t *ui)
 	if(ui->help != NULL)
 		scr_buf_delete(ui->help);
 
+	if(ui->src[0] != NULL)
+		scr_buf_delete(ui->src[0]);
+
+	if(ui->src[1] != NULL)
+		scr_buf_delete(ui->src[1]);
+
 	if(!scr_resp_isnull(ui->resp))
 		scr_resp_delete(ui->resp);
 
 	scr_pane_delete(ui->pane);
+	scr_comp_delete(ui->comp);
 	mem_free(ui);
 }
 
 
 /**
- * Render a UI widget.
+ * Render a UI widget. The panes, the help overlay, and the status line are
+ * kept on separate layers, and only damaged layers are redrawn. The panes
+ * are redrawn on every render while any pane holds a widget without dirty
+ * tracking; otherwise only after a key press reaches them, after the layout
+ * or focus changes, after a widget is invalidated, or after
+ * 'scr_ui_invalidate'. Only dirty panes render their widget again.
  *   @ui: The UI widget.
  *   @view: The target view.
  *   @focus: The focus flag.
@@ -128,18 +153,64 @@ void scr_ui_render(struct scr_ui_t *ui, struct scr_view_t view, bool focus)
 {
 	struct scr_pair_t pair;
 
-	pair = scr_pack_status(view);
-	scr_pane_render(ui->pane, pair.front, focus && scr_resp_isnull(ui->resp));
+	focus = focus && scr_resp_isnull(ui->resp);
 
-	if(ui->msg != NULL) {
-		scr_draw_view(scr_pack_horiz(&pair.back, ui->msg->box.size.width), ui->msg);
+	if(scr_comp_resize(ui->comp, view.box.size)) {
+		ui->base = ui->overlay = true;
+		ui->width = view.box.size.width;
+		ui_wrap(ui);
+	}
+
+	if(ui->base || (ui->focus != focus) || scr_pane_dirty(ui->pane)) {
+		scr_comp_clear(ui->comp, scr_layer_base_e);
+		pair = scr_pack_status(scr_comp_view(ui->comp, scr_layer_base_e));
+		scr_pane_render(ui->pane, pair.front, focus);
 
-		if(!scr_resp_isnull(ui->resp))
-			scr_edit_render(&ui->prompt, pair.back, true);
+		ui->base = false;
+		ui->focus = focus;
 	}
 
-	if(ui->help != NULL)
-		scr_draw_view(scr_pack_bottom(pair.front, ui->help->box.size.height).back, ui->help);
+	if(ui->overlay) {
+		scr_comp_clear(ui->comp, scr_layer_popup_e);
+		scr_comp_clear(ui->comp, scr_layer_status_e);
+
+		if(ui->msg != NULL) {
+			struct scr_box_t box;
+
+			pair = scr_pack_bottom(scr_comp_view(ui->comp, scr_layer_status_e), ui->msg->box.size.height ?: 1);
+			box = pair.back.box;
+			scr_blit(scr_pack_horiz(&pair.back, ui->msg->box.size.width), ui->msg);
+
+			if(!scr_resp_isnull(ui->resp))
+				scr_edit_render(&ui->prompt, pair.back, true);
+
+			scr_comp_damage(ui->comp, scr_layer_status_e, box);
+		}
+
+		if(ui->help != NULL) {
+			pair = scr_pack_status(scr_comp_view(ui->comp, scr_layer_popup_e));
+			pair = scr_pack_bottom(pair.front, ui->help->box.size.height);
+			scr_blit(pair.back, ui->help);
+			scr_comp_damage(ui->comp, scr_layer_popup_e, (struct scr_box_t){ scr_coord_add(pair.back.box.coord, ui->help->box.coord), ui->help->box.size });
+		}
+
+		ui->overlay = false;
+	}
+
+	scr_comp_render(ui->comp, view);
+}
+
+/**
+ * Invalidate the panes of the UI widget and their widgets, forcing them to
+ * be rendered again on the next render.
+ *   @ui: The UI widget.
+ */
+
+_export
+void scr_ui_invalidate(struct scr_ui_t *ui)
+{
+	ui->base = true;
+	scr_pane_invalidate(ui->pane);
 }
 
 static void ui_term(void *arg)
@@ -174,7 +245,12 @@ void scr_ui_keypress(struct scr_ui_t *ui, int32_t key, bool *term)
 	context.close = ui_term;
 	context.arg = term;
 
+	ui->overlay = true;
+
 	if(!scr_resp_isnull(ui->resp)) {
+		if(key != scr_esc_e)
+			ui->base = true;
+
 		if(scr_resp_exec(ui->resp, key, context, (struct scr_complete_h){ ui_complete, ui })) {
 			if(!scr_resp_isnull(ui->resp)) {
 				if(ui->prompt.len == 0 && key == scr_backspace_e)
@@ -187,8 +263,9 @@ void scr_ui_keypress(struct scr_ui_t *ui, int32_t key, bool *term)
 		if(!scr_resp_isnull(ui->resp) && (key == scr_esc_e)) {
 			scr_edit_destroy(&ui->prompt);
 			scr_resp_replace(&ui->resp, scr_resp_null);
-			scr_buf_replace(&ui->msg, NULL);
-			scr_buf_replace(&ui->help, NULL);
+			scr_buf_replace(&ui->src[0], NULL);
+			scr_buf_replace(&ui->src[1], NULL);
+			ui_wrap(ui);
 		}
 	}
 	else if(key == ':')
@@ -199,10 +276,11 @@ void scr_ui_keypress(struct scr_ui_t *ui, int32_t key, bool *term)
 		scr_ui_rtab(ui);
 	else {
 		if(ui->msg != NULL) {
-			scr_buf_delete(ui->msg);
-			ui->msg = NULL;
+			scr_buf_replace(&ui->src[0], NULL);
+			ui_wrap(ui);
 		}
 
+		ui->base = true;
 		scr_pane_keypress(ui->pane, key, context);
 	}
 }
@@ -219,6 +297,7 @@ void scr_ui_reset(struct scr_ui_t *ui)
 	scr_pane_delete(ui->pane);
 
 	ui->pane = ui->cur = scr_pane_new(ui->func(ui->arg));
+	ui->base = true;
 }
 
 
@@ -243,22 +322,16 @@ void scr_ui_raw(struct scr_ui_t *ui, bool raw)
 _export
 void scr_ui_msg(struct scr_ui_t *ui, struct io_chunk_t msg)
 {
-	struct scr_accum_t *accum;
-	struct scr_output_t output;
-
 	if(!scr_resp_isnull(ui->resp)) {
 		scr_resp_replace(&ui->resp, scr_resp_null);
 		scr_edit_destroy(&ui->prompt);
 	}
 
-	accum = scr_accum_new();
-
-	output = scr_output_accum(accum);
-	scr_printf(&output, "%C", msg);
+	scr_buf_replace(&ui->src[1], NULL);
+	scr_buf_replace(&ui->src[0], scr_chunk_buf(msg, 0));
+	ui_wrap(ui);
 
-	scr_buf_replace(&ui->help, NULL);
-	scr_buf_replace(&ui->msg, scr_accum_buf(accum));
-	scr_accum_delete(accum);
+	ui->overlay = true;
 }
 
 /**
@@ -270,16 +343,10 @@ void scr_ui_msg(struct scr_ui_t *ui, struct io_chunk_t msg)
 _export
 void scr_ui_help(struct scr_ui_t *ui, struct io_chunk_t msg)
 {
-	struct scr_accum_t *accum;
-	struct scr_output_t output;
-
-	accum = scr_accum_new();
-
-	output = scr_output_accum(accum);
-	scr_printf(&output, "%C", msg);
+	scr_buf_replace(&ui->src[1], scr_chunk_buf(msg, 0));
+	ui_wrap(ui);
 
-	scr_buf_replace(&ui->help, scr_accum_buf(accum));
-	scr_accum_delete(accum);
+	ui->overlay = true;
 }
 
 /**
@@ -292,24 +359,19 @@ void scr_ui_help(struct scr_ui_t *ui, struct io_chunk_t msg)
 _export
 void scr_ui_prompt(struct scr_ui_t *ui, struct io_chunk_t msg, struct scr_resp_t resp)
 {
-	struct scr_accum_t *accum;
-	struct scr_output_t output;
-
 	if(!scr_resp_isnull(ui->resp))
 		scr_edit_destroy(&ui->prompt);
 
-	accum = scr_accum_new();
-
-	output = scr_output_accum(accum);
-	scr_printf(&output, "%C", msg);
-
+	scr_buf_replace(&ui->src[0], NULL);
+	scr_buf_replace(&ui->src[1], NULL);
 	scr_buf_replace(&ui->help, NULL);
-	scr_buf_replace(&ui->msg, scr_accum_buf(accum));
-	scr_accum_delete(accum);
+	scr_buf_replace(&ui->msg, scr_chunk_buf(msg, 0));
 
 	ui->buf = NULL;
 	scr_resp_replace(&ui->resp, resp);
 	scr_edit_init(&ui->prompt, &ui->buf);
+
+	ui->overlay = true;
 }
 
 /**
@@ -335,6 +397,20 @@ static void error_proc(struct io_output_t output, const struct io_chunk_t *error
 	io_printf(output, "%C%C%C", scr_chunk_error(true), *error, scr_chunk_error(false));
 }
 
+/**
+ * Wrap the message and help to the current width. A prompt is kept on a
+ * single line for the edit widget that follows it.
+ *   @ui: The UI widget.
+ */
+
+static void ui_wrap(struct scr_ui_t *ui)
+{
+	if(scr_resp_isnull(ui->resp))
+		scr_buf_replace(&ui->msg, (ui->src[0] != NULL) ? scr_buf_wrap(ui->src[0], ui->width) : NULL);
+
+	scr_buf_replace(&ui->help, (ui->src[1] != NULL) ? scr_buf_wrap(ui->src[1], ui->width) : NULL);
+}
+
 /**
  * Clear any message or error on the UI widget.
  *   @ui: The UI widget.
@@ -348,8 +424,11 @@ void scr_ui_clear(struct scr_ui_t *ui)
 		scr_resp_replace(&ui->resp, scr_resp_null);
 	}
 
-	scr_buf_replace(&ui->msg, NULL);
-	scr_buf_replace(&ui->help, NULL);
+	scr_buf_replace(&ui->src[0], NULL);
+	scr_buf_replace(&ui->src[1], NULL);
+	ui_wrap(ui);
+
+	ui->overlay = true;
 }
 
 /**
@@ -424,6 +503,7 @@ void scr_ui_hsplit(struct scr_ui_t *ui)
 	back = scr_pane_new(ui->func(ui->arg));
 	scr_pane_set(ui->cur, scr_split_widget(scr_split_new(scr_split_horiz_e, 0.5, front, back)));
 	ui->cur = front;
+	ui->base = true;
 }
 
 /**
@@ -440,6 +520,7 @@ void scr_ui_vsplit(struct scr_ui_t *ui)
 	back = scr_pane_new(ui->func(ui->arg));
 	scr_pane_set(ui->cur, scr_split_widget(scr_split_new(scr_split_vert_e, 0.5, front, back)));
 	ui->cur = front;
+	ui->base = true;
 }
 
 _export
@@ -452,6 +533,7 @@ bool scr_ui_close(struct scr_ui_t *ui)
 		return false;
 
 	scr_split_close(&ui->pane, split);
+	ui->base = true;
 
 	return true;
 }
@@ -466,6 +548,7 @@ _export
 void scr_ui_tab(struct scr_ui_t *ui)
 {
 	ui->cur = scr_pane_tab(ui->pane) ?: ui->cur;
+	ui->base = true;
 }
 
 /**
@@ -477,6 +560,7 @@ _export
 void scr_ui_rtab(struct scr_ui_t *ui)
 {
 	ui->cur = scr_pane_rtab(ui->pane) ?: ui->cur;
+	ui->base = true;
 }
 
 
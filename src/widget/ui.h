@@ -33,6 +33,7 @@ struct scr_ui_t *scr_ui_new(scr_ui_f func, void *arg);
 void scr_ui_delete(struct scr_ui_t *ui);
 
 void scr_ui_render(struct scr_ui_t *ui, struct scr_view_t view, bool focus);
+void scr_ui_invalidate(struct scr_ui_t *ui);
 void scr_ui_keypress(struct scr_ui_t *ui, int32_t key, bool *term);
 
 void scr_ui_reset(struct scr_ui_t *ui);
@@ -14,7 +14,7 @@ static void blank_close(void *ref);
  * local variables
  */
 
-static const struct scr_widget_i blank_iface = { NULL, NULL, blank_close};
+static const struct scr_widget_i blank_iface = { NULL, NULL, blank_close, NULL, NULL };
 
 /*
  * global variables
@@ -176,16 +176,37 @@ typedef void (*scr_render_f)(void *ref, struct scr_view_t view, bool focus);
 typedef void (*scr_keypress_f)(void *ref, int32_t key, struct scr_context_t context);
 
 /**
- * Widget interface.
+ * Determine if a widget must be rendered again.
+ *   @ref: The reference.
+ *   &returns: True if dirty, false otherwise.
+ */
+
+typedef bool (*scr_dirty_f)(void *ref);
+
+/**
+ * Invalidate a widget, marking it dirty.
+ *   @ref: The reference.
+ */
+
+typedef void (*scr_invalidate_f)(void *ref);
+
+/**
+ * Widget interface. Widgets without a dirty callback do not track their
+ * own changes; panes treat them as always dirty and render them every
+ * frame.
  *   @render: Render.
  *   @keypres: Key press.
  *   @delete: Delete.
+ *   @dirty: Optional. Dirty query, cleared by rendering.
+ *   @invalidate: Optional. Invalidation.
  */
 
 struct scr_widget_i {
 	scr_render_f render;
 	scr_keypress_f keypress;
 	delete_f delete;
+	scr_dirty_f dirty;
+	scr_invalidate_f invalidate;
 };
 
 /**
@@ -246,6 +267,29 @@ static inline void scr_widget_keypress(struct scr_widget_t widget, int32_t key,
 	widget.iface->keypress(widget.ref, key, context);
 }
 
+/**
+ * Determine if a widget is dirty. Widgets without dirty tracking always
+ * report clean.
+ *   @widget: The widget.
+ *   &returns: True if dirty, false otherwise.
+ */
+
+static inline bool scr_widget_dirty(struct scr_widget_t widget)
+{
+	return (widget.iface->dirty != NULL) && widget.iface->dirty(widget.ref);
+}
+
+/**
+ * Invalidate a widget, forcing it to be rendered again.
+ *   @widget: The widget.
+ */
+
+static inline void scr_widget_invalidate(struct scr_widget_t widget)
+{
+	if(widget.iface->invalidate != NULL)
+		widget.iface->invalidate(widget.ref);
+}
+
 /**
  * Delete a widget.
  *   @widget: The widget.
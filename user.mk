@@ -2,11 +2,22 @@ HEADERS = \
 	  src/defs.h \
 	  src/widget/defs.h \
 	  \
+	  src/arena.h \
 	  src/buf.h \
+	  src/cache.h \
+	  src/dlist.h \
+	  src/fmt.h \
+	  src/headless.h \
+	  src/lat.h \
+	  src/layer.h \
+	  src/layout.h \
 	  src/output.h \
 	  src/pack.h \
 	  src/pt.h \
 	  src/scr.h \
+	  src/server.h \
+	  src/snap.h \
+	  src/vt.h \
 	  \
 	  src/widget/edit.h \
 	  src/widget/handler.h \
@@ -29,9 +40,23 @@ install: scr_h_install
 scr_h_install: scr.h
 	install --mode 0644 -D scr.h "$(PREFIX)/include/scr.h"
 
-clean: scr_h_clean
+bench: bench/bench
+	bench/bench
+
+test: bench_test
+
+bench_test: bench/bench
+	bench/bench 200
+
+bench/bench: bench/bench.c scr.h libscr.a
+	$(CC) $(CFLAGS) -o $@ $< libscr.a `pkg-config --cflags --libs shim` -lpthread
+
+clean: scr_h_clean bench_clean
 
 scr_h_clean:
 	rm -f scr.h
 
-.PHONY: scr_h_clean
+bench_clean:
+	rm -f bench/bench
+
+.PHONY: bench bench_test scr_h_clean bench_clean